@@ -0,0 +1,52 @@
+#pragma once
+
+#include "options.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace http::server {
+    class concurrency_limit {
+        const admission_options options;
+        std::atomic<std::size_t> in_flight = 0;
+        std::atomic<double> current;
+
+        auto release(std::chrono::steady_clock::duration latency) noexcept
+            -> void;
+    public:
+        class permit {
+            concurrency_limit* owner = nullptr;
+            std::chrono::steady_clock::time_point start;
+        public:
+            permit() = default;
+
+            explicit permit(concurrency_limit& owner);
+
+            permit(const permit&) = delete;
+
+            permit(permit&& other) noexcept;
+
+            ~permit();
+
+            auto operator=(const permit&) -> permit& = delete;
+
+            auto operator=(permit&& other) noexcept -> permit&;
+
+            auto release(
+                std::chrono::steady_clock::duration waiting = {}
+            ) noexcept -> void;
+        };
+
+        explicit concurrency_limit(const admission_options& options);
+
+        auto acquire() noexcept -> std::optional<permit>;
+
+        auto limit() const noexcept -> std::size_t;
+
+        auto size() const noexcept -> std::size_t;
+    };
+
+    auto admit(concurrency_limit* limit) noexcept
+        -> std::optional<concurrency_limit::permit>;
+}
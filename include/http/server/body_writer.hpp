@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ext/coroutine>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace http::server {
+    class body_writer {
+    public:
+        using sink_type = std::function<ext::task<>(std::string_view)>;
+    private:
+        std::string chunk;
+        std::size_t offset = 0;
+        bool aborted = false;
+        bool deferred = false;
+        bool finished = false;
+        bool flushed = false;
+        ext::continuation<> drained;
+        std::function<void()> notify;
+        sink_type sink;
+    public:
+        auto abort() noexcept -> void;
+
+        auto consume(std::size_t size) noexcept -> bool;
+
+        auto defer() noexcept -> void;
+
+        auto done() const noexcept -> bool;
+
+        auto finish() -> void;
+
+        auto pending() const noexcept -> std::string_view;
+
+        auto resume() noexcept -> void;
+
+        auto set_notify(std::function<void()>&& notify) -> void;
+
+        auto set_sink(sink_type&& sink) -> void;
+
+        auto take_deferred() noexcept -> bool;
+
+        auto write(std::string_view data) -> ext::task<>;
+    };
+
+    using body_producer = std::function<ext::task<>(body_writer&)>;
+
+    struct body_stream {
+        std::string content_type;
+        body_producer producer;
+    };
+
+    struct streaming_body {
+        body_producer producer;
+        std::unique_ptr<body_writer> writer = std::make_unique<body_writer>();
+    };
+}
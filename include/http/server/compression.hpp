@@ -0,0 +1,41 @@
+#pragma once
+
+#include "request.hpp"
+#include "response.hpp"
+
+namespace http::server {
+    enum class content_coding : std::uint8_t { identity, gzip, br, zstd };
+
+    struct compression_options {
+        std::size_t min_size = 1024;
+        std::size_t max_size = 1024 * 1024;
+        int gzip_level = 6;
+        int brotli_quality = 5;
+        int zstd_level = 3;
+        bool gzip = true;
+        bool brotli = true;
+        bool zstd = true;
+        bool precompressed = true;
+    };
+
+    auto compress(
+        const request& request,
+        response& response,
+        const compression_options& options
+    ) -> void;
+
+    auto compress(
+        content_coding coding,
+        std::string_view data,
+        const compression_options& options
+    ) -> std::string;
+
+    auto extension(content_coding coding) noexcept -> std::string_view;
+
+    auto negotiate(
+        std::string_view accept_encoding,
+        const compression_options& options
+    ) -> content_coding;
+
+    auto to_string(content_coding coding) noexcept -> std::string_view;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace http::server {
+    struct frame_statistics {
+        std::size_t allocations = 0;
+        std::size_t reuses = 0;
+        std::size_t cached = 0;
+    };
+
+    class frame_pool {
+        struct block {
+            block* next;
+        };
+
+        static constexpr auto granularity = std::size_t(64);
+        static constexpr auto classes = std::size_t(128);
+        static constexpr auto budget = std::size_t(256 * 1024);
+
+        std::array<block*, classes> free = {};
+        std::array<std::size_t, classes> counts = {};
+        frame_statistics stats;
+    public:
+        static constexpr auto max_size = granularity * classes;
+
+        // Returns nullptr once the calling thread's pool has been destroyed.
+        static auto local() noexcept -> frame_pool*;
+
+        frame_pool() = default;
+
+        frame_pool(const frame_pool&) = delete;
+
+        frame_pool(frame_pool&&) = delete;
+
+        ~frame_pool();
+
+        auto operator=(const frame_pool&) -> frame_pool& = delete;
+
+        auto operator=(frame_pool&&) -> frame_pool& = delete;
+
+        auto allocate(std::size_t size) -> void*;
+
+        auto deallocate(void* ptr, std::size_t size) noexcept -> void;
+
+        auto statistics() const noexcept -> frame_statistics;
+    };
+
+    namespace detail {
+        auto allocate_frame(std::size_t size) -> void*;
+
+        auto deallocate_frame(void* ptr, std::size_t size) noexcept -> void;
+
+        struct pooled_frame {
+            static auto operator new(std::size_t size) -> void* {
+                return allocate_frame(size);
+            }
+
+            static auto operator delete(void* ptr, std::size_t size) noexcept
+                -> void {
+                deallocate_frame(ptr, size);
+            }
+        };
+
+        template <typename T>
+        struct task_result {
+            std::optional<T> value;
+
+            template <typename U>
+            auto return_value(U&& u) -> void {
+                value.emplace(std::forward<U>(u));
+            }
+
+            auto get() -> T { return std::move(*value); }
+        };
+
+        template <>
+        struct task_result<void> {
+            auto return_void() noexcept -> void {}
+
+            auto get() noexcept -> void {}
+        };
+    }
+
+    // Coroutines on the request path return these instead of ext::task and
+    // ext::detached_task so that their frames come from the thread's frame
+    // pool rather than the global allocator.
+    template <typename T = void>
+    class pooled_task {
+    public:
+        struct promise_type :
+            detail::pooled_frame,
+            detail::task_result<T> {
+            std::coroutine_handle<> awaiting;
+            std::exception_ptr exception;
+
+            struct final_awaiter {
+                auto await_ready() const noexcept -> bool { return false; }
+
+                auto await_suspend(std::coroutine_handle<promise_type> handle
+                ) const noexcept -> std::coroutine_handle<> {
+                    if (auto awaiting = handle.promise().awaiting) {
+                        return awaiting;
+                    }
+
+                    return std::noop_coroutine();
+                }
+
+                auto await_resume() const noexcept -> void {}
+            };
+
+            auto final_suspend() const noexcept -> final_awaiter { return {}; }
+
+            auto get_return_object() -> pooled_task {
+                return pooled_task(
+                    std::coroutine_handle<promise_type>::from_promise(*this)
+                );
+            }
+
+            auto initial_suspend() const noexcept -> std::suspend_always {
+                return {};
+            }
+
+            auto unhandled_exception() noexcept -> void {
+                exception = std::current_exception();
+            }
+        };
+    private:
+        std::coroutine_handle<promise_type> handle;
+
+        explicit pooled_task(std::coroutine_handle<promise_type> handle) :
+            handle(handle) {}
+    public:
+        pooled_task(const pooled_task&) = delete;
+
+        pooled_task(pooled_task&& other) noexcept :
+            handle(std::exchange(other.handle, nullptr)) {}
+
+        ~pooled_task() {
+            if (handle) handle.destroy();
+        }
+
+        auto operator=(const pooled_task&) -> pooled_task& = delete;
+
+        auto operator=(pooled_task&& other) noexcept -> pooled_task& {
+            if (std::addressof(other) != this) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        auto await_ready() const noexcept -> bool { return false; }
+
+        auto await_suspend(std::coroutine_handle<> awaiting) noexcept
+            -> std::coroutine_handle<> {
+            handle.promise().awaiting = awaiting;
+            return handle;
+        }
+
+        auto await_resume() -> T {
+            auto& promise = handle.promise();
+            if (promise.exception) std::rethrow_exception(promise.exception);
+            return promise.get();
+        }
+    };
+
+    struct pooled_detached_task {
+        struct promise_type : detail::pooled_frame {
+            auto final_suspend() const noexcept -> std::suspend_never {
+                return {};
+            }
+
+            auto get_return_object() const noexcept -> pooled_detached_task {
+                return {};
+            }
+
+            auto initial_suspend() const noexcept -> std::suspend_never {
+                return {};
+            }
+
+            auto return_void() const noexcept -> void {}
+
+            auto unhandled_exception() const noexcept -> void {
+                std::terminate();
+            }
+        };
+    };
+}
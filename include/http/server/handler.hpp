@@ -8,83 +8,153 @@ namespace http::server {
         virtual ~handler() = default;
 
         virtual auto handle(stream& stream) -> ext::task<> = 0;
+
+        // Handles the request without suspending, if possible. Returns false
+        // when the request must be handled by awaiting handle() instead.
+        virtual auto try_handle(stream& stream) -> bool { return false; }
     };
 
     namespace detail {
-        template <std::constructible_from<request&> T>
-        auto make_extractor(request& request) -> ext::task<T> {
-            co_return T(request);
+        template <typename F>
+        struct signature : signature<decltype(&F::operator())> {};
+
+        template <typename R, typename... Args>
+        struct signature<R (*)(Args...)> {
+            using result = R;
+            using arguments = std::tuple<Args...>;
+        };
+
+        template <typename R, typename... Args>
+        struct signature<R (*)(Args...) noexcept> :
+            signature<R (*)(Args...)> {};
+
+        template <typename R, typename C, typename... Args>
+        struct signature<R (C::*)(Args...)> : signature<R (*)(Args...)> {};
+
+        template <typename R, typename C, typename... Args>
+        struct signature<R (C::*)(Args...) const> :
+            signature<R (*)(Args...)> {};
+
+        template <typename R, typename C, typename... Args>
+        struct signature<R (C::*)(Args...) noexcept> :
+            signature<R (*)(Args...)> {};
+
+        template <typename R, typename C, typename... Args>
+        struct signature<R (C::*)(Args...) const noexcept> :
+            signature<R (*)(Args...)> {};
+
+        template <typename T>
+        struct is_task : std::false_type {};
+
+        template <typename T>
+        struct is_task<ext::task<T>> : std::true_type {};
+
+        template <typename T>
+        concept synchronous = std::constructible_from<T, request&>;
+
+        template <typename T>
+        struct ready {
+            T value;
+
+            auto await_ready() const noexcept -> bool { return true; }
+
+            auto await_suspend(std::coroutine_handle<>) const noexcept
+                -> void {}
+
+            auto await_resume() -> T { return std::move(value); }
+        };
+
+        template <synchronous T>
+        auto make_extractor(request& request) -> ready<T> {
+            return {T(request)};
         }
 
         template <extractor::readable T>
         auto make_extractor(request& request) -> ext::task<T> {
-            co_return co_await extractor::data<T>::read(request);
+            return extractor::data<T>::read(request);
         }
 
-        template <typename Args, std::size_t... I>
-        auto extract(request& request, std::index_sequence<I...>)
-            -> ext::task<Args> {
-            co_return Args {
-                co_await make_extractor<std::tuple_element_t<I, Args>>(request
-                )...};
-        }
-
-        template <typename... Args>
-        auto extract(request& request) {
-            return extract<std::tuple<Args...>>(
-                request,
-                std::index_sequence_for<Args...>()
-            );
+        template <typename R, typename F, typename Args>
+        auto invoke(stream& stream, F& fn, Args&& args) -> void {
+            if constexpr (std::is_void_v<R>) {
+                std::apply(fn, std::forward<Args>(args));
+            }
+            else {
+                stream.response.send(std::apply(fn, std::forward<Args>(args)));
+            }
         }
 
-        template <typename... Args>
-        auto use(stream& stream, std::function<void(Args...)>& fn)
-            -> ext::task<> {
-            std::apply(fn, co_await extract<Args...>(stream.request));
-            co_return;
-        }
+        // Used only when a body extractor is present: synchronous extractors
+        // are still built in place, so this is the only frame entered before
+        // the function itself.
+        template <typename R, typename F, typename... Args>
+        auto use(stream& stream, F& fn) -> ext::task<> {
+            auto args = std::tuple<Args...> {
+                co_await make_extractor<Args>(stream.request)...};
 
-        template <response_data R, typename... Args>
-        auto use(stream& stream, std::function<R(Args...)>& fn) -> ext::task<> {
-            stream.response.send(
-                std::apply(fn, co_await extract<Args...>(stream.request))
-            );
-            co_return;
+            if constexpr (std::same_as<R, ext::task<>>) {
+                co_await std::apply(fn, std::move(args));
+            }
+            else if constexpr (is_task<R>::value) {
+                auto result = co_await std::apply(fn, std::move(args));
+                stream.response.send(std::move(result));
+            }
+            else invoke<R>(stream, fn, std::move(args));
         }
 
-        template <typename... Args>
-        auto use(stream& stream, std::function<ext::task<>(Args...)>& fn)
+        template <typename R, typename F, typename... Args>
+        auto use_task(stream& stream, F& fn, std::tuple<Args...> args)
             -> ext::task<> {
-            co_await std::apply(fn, co_await extract<Args...>(stream.request));
+            stream.response.send(co_await std::apply(fn, std::move(args)));
         }
 
-        template <response_data R, typename... Args>
-        auto use(stream& stream, std::function<ext::task<R>(Args...)>& fn)
-            -> ext::task<> {
-            stream.response.send(co_await std::apply(
-                fn,
-                co_await extract<Args...>(stream.request)
-            ));
-        }
+        template <typename F, typename R, typename Args>
+        class handler;
 
-        template <typename R, typename... Args>
-        class handler : public server::handler {
-            using function = std::function<R(Args...)>;
+        template <typename F, typename R, typename... Args>
+        class handler<F, R, std::tuple<Args...>> : public server::handler {
+            static constexpr auto inline_args = (synchronous<Args> && ...);
+
+            F fn;
 
-            function fn;
+            auto extract(request& request) -> std::tuple<Args...> {
+                return std::tuple<Args...> {Args(request)...};
+            }
         public:
-            handler(function&& fn) : fn(std::forward<function>(fn)) {}
+            handler(F&& fn) : fn(std::forward<F>(fn)) {}
 
             auto handle(stream& stream) -> ext::task<> override {
-                co_await use(stream, fn);
+                if constexpr (!inline_args || !is_task<R>::value) {
+                    return use<R, F, Args...>(stream, fn);
+                }
+                else if constexpr (std::same_as<R, ext::task<>>) {
+                    return std::apply(fn, extract(stream.request));
+                }
+                else {
+                    return use_task<R>(stream, fn, extract(stream.request));
+                }
+            }
+
+            auto try_handle(stream& stream) -> bool override {
+                if constexpr (inline_args && !is_task<R>::value) {
+                    invoke<R>(stream, fn, extract(stream.request));
+                    return true;
+                }
+                else return false;
             }
         };
     }
 
     template <typename F>
     auto make_handler(F&& f) -> std::unique_ptr<handler> {
-        return std::unique_ptr<handler>(
-            new detail::handler(std::function(std::forward<F>(f)))
-        );
+        using function = std::decay_t<F>;
+        using signature = detail::signature<function>;
+
+        return std::unique_ptr<handler>(new detail::handler<
+                                        function,
+                                        typename signature::result,
+                                        typename signature::arguments>(
+            function(std::forward<F>(f))
+        ));
     }
 }
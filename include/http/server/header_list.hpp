@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace http::server {
+    auto status_string(int status) noexcept -> std::string_view;
+
+    class header_list {
+    public:
+        struct field {
+            std::string_view name;
+            std::string_view value;
+            bool static_name;
+        };
+
+        using const_iterator = std::pmr::vector<field>::const_iterator;
+    private:
+        static constexpr std::size_t inline_fields = 12;
+
+        std::array<std::byte, 1024> buffer;
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::vector<field> fields;
+
+        auto copy(std::string_view string) -> std::string_view;
+
+        auto intern(std::string_view name) -> field;
+    public:
+        header_list();
+
+        header_list(const header_list& other);
+
+        header_list(header_list&& other);
+
+        auto operator=(const header_list& other) -> header_list&;
+
+        auto operator=(header_list&& other) -> header_list&;
+
+        auto begin() const noexcept -> const_iterator;
+
+        auto clear() -> void;
+
+        auto contains(std::string_view name) const noexcept -> bool;
+
+        auto emplace(std::string_view name, std::string_view value) -> bool;
+
+        auto emplace(std::string_view name, std::size_t value) -> bool;
+
+        auto empty() const noexcept -> bool;
+
+        auto end() const noexcept -> const_iterator;
+
+        auto erase(std::string_view name) noexcept -> bool;
+
+        auto find(std::string_view name) const noexcept -> const field*;
+
+        auto set(std::string_view name, std::string_view value) -> void;
+
+        auto size() const noexcept -> std::size_t;
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http::server {
+    class header_map {
+    public:
+        using key_type = std::string_view;
+        using mapped_type = std::string_view;
+        using value_type = std::pair<std::string_view, std::string_view>;
+        using const_iterator = std::pmr::vector<value_type>::const_iterator;
+
+        static constexpr auto hash(std::string_view name) noexcept
+            -> std::uint32_t {
+            auto result = std::uint32_t(2166136261);
+
+            for (const auto c : name) {
+                result ^= static_cast<std::uint8_t>(c);
+                result *= 16777619;
+            }
+
+            return result;
+        }
+    private:
+        static constexpr std::size_t initial_capacity = 16;
+
+        std::pmr::vector<value_type> entries;
+        std::pmr::vector<std::uint32_t> hashes;
+    public:
+        header_map() = default;
+
+        explicit header_map(std::pmr::memory_resource* resource);
+
+        auto begin() const noexcept -> const_iterator;
+
+        auto contains(std::string_view name) const noexcept -> bool;
+
+        auto emplace(std::string_view name, std::string_view value) -> void;
+
+        auto empty() const noexcept -> bool;
+
+        auto end() const noexcept -> const_iterator;
+
+        auto find(std::string_view name) const noexcept -> const_iterator;
+
+        auto size() const noexcept -> std::size_t;
+    };
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace http::server::http1 {
+    struct request_line {
+        std::string_view method;
+        std::string_view target;
+        std::string_view authority;
+        int minor_version = 1;
+    };
+
+    struct head_info {
+        std::optional<std::size_t> content_length;
+        bool chunked = false;
+        bool keep_alive = true;
+        bool expect_continue = false;
+    };
+
+    namespace detail {
+        auto apply(
+            head_info& info,
+            std::string_view name,
+            std::string_view value
+        ) -> void;
+
+        auto find(std::string_view data, char c) noexcept -> std::size_t;
+
+        auto line_end(std::string_view data) -> std::size_t;
+
+        auto parse_header(std::span<char> line)
+            -> std::pair<std::string_view, std::string_view>;
+
+        auto parse_request_line(std::string_view line) -> request_line;
+    }
+
+    auto head_size(std::string_view data) noexcept -> std::size_t;
+
+    template <typename F>
+    auto parse_head(std::span<char> head, request_line& line, F&& on_header)
+        -> head_info {
+        auto data = std::string_view(head.data(), head.size());
+
+        auto end = detail::line_end(data);
+        line = detail::parse_request_line(data.substr(0, end));
+
+        auto info = head_info();
+        info.keep_alive = line.minor_version > 0;
+
+        auto pos = detail::find(data, '\n') + 1;
+
+        while (pos < data.size()) {
+            end = detail::line_end(data.substr(pos));
+            if (end == 0) break;
+
+            const auto [name, value] =
+                detail::parse_header(head.subspan(pos, end));
+
+            detail::apply(info, name, value);
+            on_header(name, value);
+
+            pos += detail::find(data.substr(pos), '\n') + 1;
+        }
+
+        return info;
+    }
+
+    class chunked_decoder {
+        enum class state { size, data, data_end, trailer, done };
+
+        state current = state::size;
+        std::size_t remaining = 0;
+    public:
+        auto decode(std::string_view& input) -> std::optional<std::string_view>;
+
+        auto done() const noexcept -> bool;
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "parser.hpp"
+
+#include "../admission.hpp"
+#include "../metrics.hpp"
+#include "../options.hpp"
+#include "../router.hpp"
+#include "../send_batch.hpp"
+#include "../socket.hpp"
+#include "../timer_wheel.hpp"
+
+#include <memory_resource>
+#include <netcore/netcore>
+
+namespace http::server::http1 {
+    class session {
+        friend struct fmt::formatter<session>;
+
+        session* next = this;
+        session* prev = this;
+
+        std::pmr::unsynchronized_pool_resource memory;
+        server::stream stream;
+        std::int32_t requests = 0;
+        server::socket socket;
+        http1_options options;
+        limit_options limits;
+        timeout_options timeouts;
+        send_batch batch;
+        std::string partial;
+        std::span<const std::byte> pending;
+        http::server::router* router = nullptr;
+        server::counters* counters = nullptr;
+        concurrency_limit* admission = nullptr;
+        ext::counter tasks;
+        ext::continuation<> closed;
+        ext::continuation<> done;
+        server::timeout deadline;
+        bool finished = false;
+        bool continue_sent = false;
+        bool draining = false;
+        bool idle = false;
+
+        auto await_close() -> ext::task<>;
+
+        auto deliver(std::span<const std::byte> data) -> ext::task<>;
+
+        auto fail(const error_code& error) -> ext::task<>;
+
+        auto handle_request(concurrency_limit::permit permit)
+            -> pooled_detached_task;
+
+        auto produce(streaming_body& body, bool chunked) -> ext::task<bool>;
+
+        auto read() -> ext::task<bool>;
+
+        auto read_body(const head_info& info) -> ext::task<bool>;
+
+        auto read_body_data() -> ext::task<bool>;
+
+        auto read_head() -> ext::task<std::optional<std::string_view>>;
+
+        auto recv() -> ext::task<>;
+
+        auto recv_chunked() -> ext::task<bool>;
+
+        auto recv_length(std::size_t length) -> ext::task<bool>;
+
+        auto refuse() -> void;
+
+        auto time_out() -> void;
+
+        auto respond(const request_line& line, bool keep_alive)
+            -> pooled_task<bool>;
+
+        auto unlink() noexcept -> void;
+
+        auto write_chunk(std::string_view data, bool chunked) -> ext::task<>;
+    public:
+        session() = default;
+
+        session(
+            server::socket&& socket,
+            const server::options& options,
+            http::server::router& router,
+            server::counters& counters,
+            concurrency_limit* admission
+        );
+
+        session(const session&) = delete;
+
+        session(session&&) = delete;
+
+        ~session();
+
+        auto operator=(const session&) -> session& = delete;
+
+        auto operator=(session&&) -> session& = delete;
+
+        auto abandoned() const noexcept -> bool;
+
+        auto await_handlers() -> ext::task<>;
+
+        auto close() noexcept -> void;
+
+        auto drain() noexcept -> void;
+
+        auto handle_connection() -> ext::task<>;
+
+        auto link(session& other) noexcept -> void;
+    };
+}
+
+template <>
+struct fmt::formatter<http::server::http1::session> :
+    formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(
+        const http::server::http1::session& session,
+        FormatContext& ctx
+    ) {
+        auto buffer = memory_buffer();
+        auto out = std::back_inserter(buffer);
+
+        fmt::format_to(out, "HTTP/1.1 Session ({})", ptr(&session));
+
+        return formatter<std::string_view>::format(
+            {buffer.data(), buffer.size()},
+            ctx
+        );
+    }
+};
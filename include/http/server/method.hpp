@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace http::server {
+    enum class method_type : std::uint8_t {
+        connect,
+        del,
+        get,
+        head,
+        options,
+        patch,
+        post,
+        put,
+        trace,
+        extension
+    };
+
+    constexpr auto method_count = static_cast<std::size_t>(
+        method_type::extension
+    );
+
+    auto parse_method(std::string_view method) noexcept -> method_type;
+
+    auto to_string(method_type method) noexcept -> std::string_view;
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "admission.hpp"
+#include "compression.hpp"
 #include "handler.hpp"
+#include "options.hpp"
 
 #define HTTP_METHOD(name, str)                                                 \
     template <typename F>                                                      \
@@ -18,9 +21,13 @@
 
 namespace http::server {
     class method_router {
-        std::string allowed_cache;
-        bool cache_invalid = true;
-        std::unordered_map<std::string_view, std::unique_ptr<handler>> methods;
+        std::array<std::unique_ptr<handler>, method_count> methods;
+        std::unordered_map<std::string_view, std::unique_ptr<handler>>
+            extensions;
+        std::string allow;
+        std::optional<compression_options> compression_opts;
+        std::optional<limit_options> limit_opts;
+        std::unique_ptr<concurrency_limit> admission;
     public:
         method_router() = default;
 
@@ -32,17 +39,32 @@ namespace http::server {
 
         auto operator=(method_router&&) -> method_router& = default;
 
-        auto allowed() -> std::string_view;
+        auto admit() noexcept -> std::optional<concurrency_limit::permit>;
 
-        auto allowed() const -> std::string;
+        auto allowed() const noexcept -> std::string_view;
+
+        auto compress(const compression_options& options = {})
+            -> method_router&;
+
+        auto compression() const noexcept
+            -> const std::optional<compression_options>&;
+
+        auto concurrency(const admission_options& options) -> method_router&;
 
         auto find(std::string_view method) -> handler*;
 
+        auto find(method_type type, std::string_view method) -> handler*;
+
+        auto limit(const limit_options& options) -> method_router&;
+
+        auto limits() const noexcept -> const std::optional<limit_options>&;
+
+        auto use(std::string_view method, std::unique_ptr<handler>&& handler)
+            -> method_router&;
+
         template <typename F>
         auto use(std::string_view method, F&& f) -> method_router& {
-            methods.emplace(method, make_handler(std::forward<F>(f)));
-            cache_invalid = true;
-            return *this;
+            return use(method, make_handler(std::forward<F>(f)));
         }
 
         HTTP_METHOD(del, "DELETE")
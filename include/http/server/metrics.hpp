@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace http::server {
+    struct metrics {
+        std::uint64_t connections = 0;
+        std::uint64_t active_connections = 0;
+        std::uint64_t requests = 0;
+        std::uint64_t refused = 0;
+
+        auto operator+=(const metrics& other) noexcept -> metrics&;
+    };
+
+    class counters {
+        std::atomic<std::uint64_t> connections = 0;
+        std::atomic<std::uint64_t> closed = 0;
+        std::atomic<std::uint64_t> requests = 0;
+        std::atomic<std::uint64_t> refused = 0;
+    public:
+        auto connection_closed() noexcept -> void;
+
+        auto connection_opened() noexcept -> void;
+
+        auto refuse() noexcept -> void;
+
+        auto request() noexcept -> void;
+
+        auto snapshot() const noexcept -> metrics;
+    };
+}
@@ -17,8 +17,13 @@ namespace http::server {
 
     enum class node_type { static_route, param, catch_all };
 
+    template <typename T>
+    class route_table;
+
     template <typename T>
     class node {
+        friend class route_table<T>;
+
         node_type type = node_type::static_route;
         std::string prefix;
         std::optional<T> value;
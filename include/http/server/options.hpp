@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace http::server {
+    struct http2_settings {
+        std::optional<std::uint32_t> header_table_size;
+        std::optional<std::uint32_t> max_concurrent_streams = 100;
+        std::optional<std::uint32_t> initial_window_size;
+        std::optional<std::uint32_t> max_frame_size;
+        std::optional<std::uint32_t> max_header_list_size;
+        // Enables RFC 9218 priorities; unsetting it also disables
+        // response::priority.
+        std::optional<std::uint32_t> no_rfc7540_priorities = 1;
+    };
+
+    struct http2_options {
+        http2_settings settings;
+        std::optional<std::int32_t> connection_window_size;
+        std::optional<std::size_t> max_deflate_dynamic_table_size;
+        std::optional<std::size_t> max_send_header_block_length;
+        std::optional<std::size_t> max_outbound_ack;
+        std::optional<std::size_t> max_settings;
+    };
+
+    struct http1_options {
+        std::size_t max_head_size = 16 * 1024;
+    };
+
+    struct timeout_options {
+        std::chrono::milliseconds idle = std::chrono::seconds(60);
+        std::chrono::milliseconds header = std::chrono::seconds(10);
+        std::chrono::milliseconds body = std::chrono::seconds(30);
+        std::chrono::milliseconds handler = std::chrono::milliseconds::zero();
+    };
+
+    struct admission_options {
+        std::size_t limit = 1024;
+        std::size_t min_limit = 16;
+        std::size_t max_limit = 4096;
+        std::optional<std::chrono::milliseconds> target_latency;
+    };
+
+    struct limit_options {
+        std::optional<std::size_t> max_body_size;
+        std::size_t max_header_count = 100;
+        std::size_t max_header_list_size = 16 * 1024;
+    };
+
+    struct send_options {
+        std::size_t max_batch = 64 * 1024;
+        unsigned int coalesce_turns = 0;
+    };
+
+    struct options {
+        std::size_t buffer_size = 8 * 1024;
+        std::optional<admission_options> admission;
+        std::chrono::milliseconds drain_timeout = std::chrono::seconds(30);
+        http1_options http1;
+        http2_options http2;
+        limit_options limits;
+        send_options send;
+        timeout_options timeouts;
+    };
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "request.hpp"
+#include "response.hpp"
+
+#include <vector>
+
+namespace http::server {
+    struct byte_range {
+        std::size_t offset;
+        std::size_t length;
+
+        auto operator==(const byte_range&) const noexcept -> bool = default;
+    };
+
+    // Returns std::nullopt when the header should be ignored, and an empty
+    // list when none of the ranges can be satisfied.
+    auto parse_range(std::string_view header, std::size_t size)
+        -> std::optional<std::vector<byte_range>>;
+
+    auto serve_range(const request& request, response& response) -> void;
+}
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "header_map.hpp"
+#include "method.hpp"
+
 #include <http/media_type.hpp>
 #include <http/parser.hpp>
 
+#include <chrono>
 #include <ext/coroutine>
+#include <memory_resource>
 #include <optional>
 #include <span>
 #include <unordered_map>
@@ -25,14 +30,7 @@ namespace http::server {
             std::string_view name,
             std::string_view description
         ) -> T {
-            using key_type = typename Map::key_type;
-
-            auto key = key_type();
-
-            if constexpr (std::same_as<key_type, std::string_view>) key = name;
-            else key = std::string(name);
-
-            const auto result = map.find(key);
+            const auto result = map.find(name);
 
             if (result != map.end()) {
                 const auto& value = result->second;
@@ -67,19 +65,34 @@ namespace http::server {
         }
     }
 
+    // The method, path, scheme, authority, params, query and headers are
+    // views into the stream's arena, which is reused once the handler
+    // returns. Anything kept longer must be copied, for example with
+    // header<std::string>(), path_param<std::string>() or
+    // query_param<std::string>().
     struct request {
-        std::string method;
+        using map_type =
+            std::pmr::unordered_map<std::string_view, std::string_view>;
+
+        std::string_view method;
+        method_type verb = method_type::extension;
         std::string_view path;
-        std::unordered_map<std::string_view, std::string_view> params;
-        std::unordered_map<std::string_view, std::string_view> query;
-        std::unordered_map<std::string, std::string> headers;
-        std::string scheme;
-        std::string authority;
+        map_type params;
+        map_type query;
+        header_map headers;
+        std::string_view scheme;
+        std::string_view authority;
         std::span<const std::byte> data;
         bool eof = false;
         bool discard = false;
+        std::optional<std::size_t> max_body_size;
+        std::chrono::steady_clock::duration waiting = {};
         ext::continuation<> continuation;
 
+        request() = default;
+
+        request(std::pmr::memory_resource* resource);
+
         auto content_type() const -> media_type;
 
         auto expect_content_type(const media_type& expected) const -> void;
@@ -1,17 +1,45 @@
 #pragma once
 
+#include "body_writer.hpp"
+#include "header_list.hpp"
+
 #include <http/media_type.hpp>
 
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <netcore/netcore>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <vector>
+#include <variant>
 
 namespace http::server {
+    struct encoded_file {
+        std::shared_ptr<const netcore::fd> fd;
+        std::size_t size = 0;
+    };
+
+    // Precompressed siblings of a file, indexed by content coding.
+    using file_encodings = std::array<encoded_file, 4>;
+
     struct file {
         netcore::fd fd;
         std::size_t size;
         std::string content_type;
+        std::string path;
+        std::shared_ptr<const netcore::fd> shared;
+        std::size_t offset = 0;
+        std::shared_ptr<const file_encodings> encodings;
+
+        auto descriptor() const noexcept -> int {
+            return shared ? *shared : fd;
+        }
+    };
+
+    // RFC 9218 priority parameters: urgency ranges from 0 (highest) to 7.
+    struct priority {
+        std::uint8_t urgency = 3;
+        bool incremental = false;
     };
 
     struct response;
@@ -28,12 +56,21 @@ namespace http::server {
 
     struct response {
         int status = 200;
-        std::unordered_map<std::string, std::string> headers;
-        std::variant<std::monostate, std::string, file> data;
+        header_list headers;
+        std::variant<std::monostate, std::string, file, streaming_body> data;
+        std::optional<server::priority> priority;
         std::size_t written = 0;
 
+        auto clear() -> void {
+            status = 200;
+            headers.clear();
+            data = std::monostate();
+            priority.reset();
+            written = 0;
+        }
+
         auto content_length(std::size_t length) -> void {
-            headers.emplace("content-length", std::to_string(length));
+            headers.emplace("content-length", length);
         }
 
         auto content_type(const media_type& type) -> void {
@@ -2,4 +2,5 @@
 #include "int.hpp"
 #include "json.hpp"
 #include "optional.hpp"
+#include "stream.hpp"
 #include "string.hpp"
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../response.hpp"
+
+namespace http::server {
+    template <>
+    struct response_type<body_stream> {
+        static auto send(response& res, body_stream&& stream) -> void {
+            res.content_type(media_type(stream.content_type));
+            res.data = streaming_body {.producer = std::move(stream.producer)};
+        }
+    };
+}
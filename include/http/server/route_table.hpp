@@ -0,0 +1,300 @@
+#pragma once
+
+#include "node.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace http::server {
+    template <typename T, std::size_t N>
+    class inline_vector {
+        std::array<T, N> items;
+        std::size_t count = 0;
+    public:
+        auto begin() const noexcept { return items.begin(); }
+
+        auto empty() const noexcept -> bool { return count == 0; }
+
+        auto end() const noexcept { return items.begin() + count; }
+
+        auto push_back(const T& item) noexcept -> void {
+            items[count++] = item;
+        }
+
+        auto resize(std::size_t size) noexcept -> void { count = size; }
+
+        auto size() const noexcept -> std::size_t { return count; }
+    };
+
+    template <typename T>
+    class route_table {
+        static constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+        static constexpr auto max_depth = std::size_t(64);
+    public:
+        static constexpr auto max_params = std::size_t(16);
+
+        using param_list = inline_vector<
+            std::pair<std::string_view, std::string_view>,
+            max_params>;
+
+        struct match {
+            T* value;
+            param_list params;
+        };
+    private:
+        // Children of a node are stored contiguously: static children with a
+        // prefix first, ordered by their first byte so that the jump table
+        // can find them, followed by everything else in insertion order.
+        struct entry {
+            node_type type = node_type::static_route;
+            std::uint8_t low = 0;
+            std::uint16_t span = 0;
+            std::uint32_t prefix = 0;
+            std::uint32_t length = 0;
+            std::uint32_t value = none;
+            std::uint32_t children = 0;
+            std::uint32_t statics = 0;
+            std::uint32_t end = 0;
+            std::uint32_t jump = 0;
+        };
+
+        struct frame {
+            std::uint32_t next;
+            std::uint32_t statics;
+            std::uint32_t other;
+            std::uint32_t end;
+            std::size_t position;
+            std::size_t params;
+            char byte;
+        };
+
+        std::vector<entry> entries;
+        std::vector<std::uint32_t> jumps;
+        std::vector<T> values;
+        std::string text;
+
+        auto first(const entry& entry) const noexcept -> char {
+            return text[entry.prefix];
+        }
+
+        auto name(const entry& entry) const noexcept -> std::string_view {
+            return {text.data() + entry.prefix, entry.length};
+        }
+
+        auto push(
+            const entry& parent,
+            std::string_view route,
+            std::size_t position,
+            std::size_t params
+        ) const noexcept -> frame {
+            auto result = frame {
+                .next = parent.statics,
+                .statics = parent.statics,
+                .other = parent.statics,
+                .end = parent.end,
+                .position = position,
+                .params = params,
+                .byte = route[position]};
+
+            const auto byte = static_cast<unsigned char>(result.byte);
+
+            if (byte >= parent.low && byte - parent.low < parent.span) {
+                const auto child = jumps[parent.jump + byte - parent.low];
+                if (child != none) result.next = child;
+            }
+
+            return result;
+        }
+
+        auto take(frame& frame) const noexcept -> std::uint32_t {
+            if (frame.next < frame.statics &&
+                first(entries[frame.next]) == frame.byte) {
+                return frame.next++;
+            }
+
+            frame.next = frame.statics;
+
+            if (frame.other < frame.end) return frame.other++;
+            return none;
+        }
+    public:
+        route_table() = default;
+
+        explicit route_table(node<T>&& root) {
+            struct pending {
+                node<T>* source;
+                std::uint32_t index;
+                std::size_t depth;
+                std::size_t params;
+            };
+
+            auto queue = std::vector<pending> {{&root, 0, 1, 0}};
+            entries.emplace_back();
+
+            for (auto i = std::size_t(); i < queue.size(); ++i) {
+                auto [current, index, depth, params] = queue[i];
+
+                if (current->type != node_type::static_route) ++params;
+
+                if (depth > max_depth) {
+                    throw std::runtime_error("route tree is too deep");
+                }
+
+                if (params > max_params) {
+                    throw std::runtime_error(fmt::format(
+                        "route has more than {} parameters",
+                        max_params
+                    ));
+                }
+
+                auto children = std::vector<node<T>*>();
+                children.reserve(current->children.size());
+
+                for (auto& child : current->children) {
+                    if (child.type == node_type::static_route &&
+                        !child.prefix.empty()) {
+                        children.push_back(&child);
+                    }
+                }
+
+                std::stable_sort(
+                    children.begin(),
+                    children.end(),
+                    [](const node<T>* a, const node<T>* b) {
+                        return static_cast<unsigned char>(a->prefix[0]) <
+                               static_cast<unsigned char>(b->prefix[0]);
+                    }
+                );
+
+                const auto statics = children.size();
+
+                for (auto& child : current->children) {
+                    if (child.type != node_type::static_route ||
+                        child.prefix.empty()) {
+                        children.push_back(&child);
+                    }
+                }
+
+                auto& entry = entries[index];
+
+                entry.type = current->type;
+                entry.prefix = static_cast<std::uint32_t>(text.size());
+                entry.length =
+                    static_cast<std::uint32_t>(current->prefix.size());
+                text.append(current->prefix);
+
+                if (current->value) {
+                    entry.value = static_cast<std::uint32_t>(values.size());
+                    values.push_back(std::move(*current->value));
+                }
+
+                entry.children = static_cast<std::uint32_t>(entries.size());
+                entry.statics = entry.children + statics;
+                entry.end = entry.children + children.size();
+
+                if (statics > 0) {
+                    const auto low =
+                        static_cast<unsigned char>(children[0]->prefix[0]);
+                    const auto high = static_cast<unsigned char>(
+                        children[statics - 1]->prefix[0]
+                    );
+
+                    entry.low = low;
+                    entry.span = high - low + 1;
+                    entry.jump = static_cast<std::uint32_t>(jumps.size());
+
+                    jumps.resize(jumps.size() + entry.span, none);
+
+                    for (auto j = statics; j > 0; --j) {
+                        const auto byte = static_cast<unsigned char>(
+                            children[j - 1]->prefix[0]
+                        );
+
+                        jumps[entry.jump + byte - low] =
+                            entry.children + static_cast<std::uint32_t>(j - 1);
+                    }
+                }
+
+                for (auto* child : children) {
+                    queue.push_back({
+                        child,
+                        static_cast<std::uint32_t>(entries.size()),
+                        depth + 1,
+                        params});
+                    entries.emplace_back();
+                }
+            }
+        }
+
+        auto find(std::string_view route) -> std::optional<match> {
+            if (route.size() > 1 && route.ends_with('/')) {
+                route = {route.begin(), route.end() - 1};
+            }
+
+            auto result = match {.value = nullptr};
+
+            std::array<frame, max_depth> stack;
+            stack[0] = frame {.next = 0, .statics = 0, .other = 0, .end = 1};
+            auto depth = std::size_t(1);
+
+            while (depth > 0) {
+                auto& top = stack[depth - 1];
+
+                const auto index = take(top);
+                if (index == none) {
+                    --depth;
+                    continue;
+                }
+
+                const auto& entry = entries[index];
+                auto position = top.position;
+                result.params.resize(top.params);
+
+                switch (entry.type) {
+                    case node_type::static_route:
+                        if (!route.substr(position).starts_with(name(entry))) {
+                            continue;
+                        }
+                        position += entry.length;
+                        break;
+                    case node_type::param: {
+                        const auto slash = route.find('/', position);
+                        const auto end =
+                            slash == std::string_view::npos ? route.size()
+                                                            : slash;
+
+                        result.params.push_back({
+                            name(entry),
+                            route.substr(position, end - position)});
+                        position = end;
+                        break;
+                    }
+                    case node_type::catch_all:
+                        if (entry.value == none) continue;
+                        result.params.push_back(
+                            {name(entry), route.substr(position)}
+                        );
+                        result.value = &values[entry.value];
+                        return result;
+                }
+
+                if (position == route.size()) {
+                    if (entry.value == none) continue;
+                    result.value = &values[entry.value];
+                    return result;
+                }
+
+                if (entry.children == entry.end) continue;
+
+                stack[depth++] =
+                    push(entry, route, position, result.params.size());
+            }
+
+            return std::nullopt;
+        }
+
+        auto size() const noexcept -> std::size_t { return values.size(); }
+    };
+}
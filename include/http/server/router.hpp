@@ -1,16 +1,32 @@
 #pragma once
 
+#include "frame_pool.hpp"
 #include "method_router.hpp"
-#include "node.hpp"
+#include "route_table.hpp"
+#include "routing.hpp"
 
 namespace http::server {
     using path = node<method_router>;
 
     class router {
-        path paths;
+        using route_match = route_table<method_router>::match;
+
+        using finder = auto (*)(std::string_view, std::span<method_router>)
+            -> std::optional<route_match>;
+
+        route_table<method_router> table;
+        std::vector<method_router> routes;
+        finder lookup = nullptr;
+
+        auto find(std::string_view path) -> std::optional<route_match>;
     public:
         router(path&& paths);
 
-        auto route(stream& stream) -> ext::task<bool>;
+        template <typename... Routes>
+        router(routing::table<Routes...>) :
+            routes(routing::table<Routes...>::handlers()),
+            lookup(&routing::table<Routes...>::find) {}
+
+        auto route(stream& stream) -> pooled_task<bool>;
     };
 }
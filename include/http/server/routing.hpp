@@ -0,0 +1,484 @@
+#pragma once
+
+#include "extractor/path.hpp"
+#include "method_router.hpp"
+#include "route_table.hpp"
+
+#include <bit>
+#include <span>
+
+namespace http::server::routing {
+    namespace detail {
+        enum class segment_type { literal, param, catch_all };
+
+        struct segment {
+            segment_type type = segment_type::literal;
+            std::string_view text;
+        };
+
+        constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+
+        constexpr auto hash(std::string_view string, std::uint64_t seed)
+            -> std::uint64_t {
+            auto result = 0xcbf29ce484222325 ^ (seed * 0x9e3779b97f4a7c15);
+
+            for (const auto c : string) {
+                result ^= static_cast<unsigned char>(c);
+                result *= 0x100000001b3;
+            }
+
+            return result ^ (result >> 32);
+        }
+
+        constexpr auto normalize(std::string_view path) -> std::string_view {
+            if (path.size() > 1 && path.ends_with('/')) {
+                path.remove_suffix(1);
+            }
+
+            return path;
+        }
+
+        constexpr auto count_segments(std::string_view path) -> std::size_t {
+            if (path.size() <= 1) return 0;
+
+            auto result = std::size_t(1);
+            for (const auto c : path.substr(1)) {
+                if (c == '/') ++result;
+            }
+
+            return result;
+        }
+
+        template <std::size_t N>
+        constexpr auto split(std::string_view path)
+            -> std::array<segment, N> {
+            auto result = std::array<segment, N>();
+            auto rest = path.substr(std::min(path.size(), std::size_t(1)));
+
+            for (auto& segment : result) {
+                const auto slash = rest.find('/');
+                auto text = rest.substr(0, slash);
+
+                rest = slash == std::string_view::npos ? std::string_view()
+                                                       : rest.substr(slash + 1);
+
+                if (text.starts_with(':')) {
+                    segment.type = segment_type::param;
+                    text.remove_prefix(1);
+                }
+                else if (text.starts_with('*')) {
+                    segment.type = segment_type::catch_all;
+                    text.remove_prefix(1);
+                }
+
+                segment.text = text;
+            }
+
+            return result;
+        }
+
+        template <std::size_t N>
+        constexpr auto declares(
+            const std::array<segment, N>& segments,
+            std::string_view name
+        ) -> bool {
+            if (name.empty()) return true;
+
+            for (const auto& segment : segments) {
+                if (segment.type != segment_type::literal &&
+                    segment.text == name) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        template <std::size_t N>
+        constexpr auto valid(const std::array<segment, N>& segments) -> bool {
+            for (auto i = std::size_t(); i < N; ++i) {
+                const auto& segment = segments[i];
+
+                if (segment.type == segment_type::literal) continue;
+                if (segment.text.empty()) return false;
+
+                if (segment.type == segment_type::catch_all && i + 1 != N) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Hash and displace: keys are first spread over a small number of
+        // buckets, then each bucket gets the seed that places all of its keys
+        // in free slots.
+        template <std::size_t N>
+        struct perfect_hash {
+            static constexpr auto buckets =
+                std::bit_ceil(std::max(N / 2, std::size_t(1)));
+            static constexpr auto capacity =
+                std::bit_ceil(std::max(N * 2, std::size_t(1)));
+
+            std::array<std::uint64_t, buckets> seeds = {};
+            std::array<std::uint32_t, capacity> slots = {};
+            bool complete = false;
+            bool duplicate = false;
+
+            constexpr auto find(std::string_view key) const noexcept
+                -> std::uint32_t {
+                const auto seed = seeds[hash(key, 0) & (buckets - 1)];
+                return slots[hash(key, seed) & (capacity - 1)];
+            }
+        };
+
+        template <std::size_t N>
+        constexpr auto make_perfect_hash(
+            const std::array<std::string_view, N>& keys
+        ) -> perfect_hash<N> {
+            using table = perfect_hash<N>;
+
+            auto result = table();
+            result.slots.fill(none);
+
+            auto homes = std::array<std::size_t, N>();
+            auto sizes = std::array<std::size_t, table::buckets>();
+
+            for (auto i = std::size_t(); i < N; ++i) {
+                homes[i] = hash(keys[i], 0) & (table::buckets - 1);
+                ++sizes[homes[i]];
+            }
+
+            auto order = std::array<std::size_t, table::buckets>();
+            for (auto i = std::size_t(); i < table::buckets; ++i) order[i] = i;
+
+            // Place the largest buckets first while the table is empty.
+            std::ranges::sort(order, [&](std::size_t a, std::size_t b) {
+                return sizes[a] > sizes[b];
+            });
+
+            auto members = std::array<std::uint32_t, N>();
+            auto positions = std::array<std::size_t, N>();
+
+            for (const auto bucket : order) {
+                if (sizes[bucket] == 0) break;
+
+                auto size = std::size_t();
+                for (auto i = std::size_t(); i < N; ++i) {
+                    if (homes[i] != bucket) continue;
+
+                    // Equal keys always share a bucket and can never be
+                    // placed apart.
+                    for (auto j = std::size_t(); j < size; ++j) {
+                        if (keys[members[j]] == keys[i]) {
+                            result.duplicate = true;
+                            return result;
+                        }
+                    }
+
+                    members[size++] = static_cast<std::uint32_t>(i);
+                }
+
+                auto placed = false;
+
+                for (auto seed = std::uint64_t(1); seed < 65536 && !placed;
+                     ++seed) {
+                    placed = true;
+
+                    for (auto i = std::size_t(); i < size && placed; ++i) {
+                        const auto position =
+                            hash(keys[members[i]], seed) &
+                            (table::capacity - 1);
+
+                        placed = result.slots[position] == none;
+
+                        for (auto j = std::size_t(); j < i && placed; ++j) {
+                            placed = positions[j] != position;
+                        }
+
+                        positions[i] = position;
+                    }
+
+                    if (!placed) continue;
+
+                    result.seeds[bucket] = seed;
+                    for (auto i = std::size_t(); i < size; ++i) {
+                        result.slots[positions[i]] = members[i];
+                    }
+                }
+
+                if (!placed) return result;
+            }
+
+            result.complete = true;
+            return result;
+        }
+
+        template <typename T>
+        struct path_parameter {
+            static constexpr auto value = std::string_view();
+        };
+
+        template <extractor::fixed_string Name, typename T>
+        struct path_parameter<extractor::path<Name, T>> {
+            static constexpr auto value = Name.str();
+        };
+
+        template <typename Args>
+        struct path_parameters;
+
+        template <typename... Args>
+        struct path_parameters<std::tuple<Args...>> {
+            static constexpr auto value =
+                std::array<std::string_view, sizeof...(Args) + 1> {
+                    path_parameter<std::remove_cvref_t<Args>>::value...};
+        };
+    }
+
+    template <extractor::fixed_string Method, auto Handler>
+    struct method {
+        static constexpr auto name = Method.str();
+        static constexpr auto handler = Handler;
+
+        static constexpr auto parameters() {
+            return detail::path_parameters<typename server::detail::signature<
+                decltype(Handler)>::arguments>::value;
+        }
+    };
+
+    template <auto Handler>
+    using del = method<"DELETE", Handler>;
+
+    template <auto Handler>
+    using get = method<"GET", Handler>;
+
+    template <auto Handler>
+    using head = method<"HEAD", Handler>;
+
+    template <auto Handler>
+    using post = method<"POST", Handler>;
+
+    template <auto Handler>
+    using put = method<"PUT", Handler>;
+
+    template <extractor::fixed_string Path, typename... Methods>
+    class route {
+        static constexpr auto size = detail::count_segments(Path.str());
+        static constexpr auto segments = detail::split<size>(Path.str());
+
+        template <typename Method>
+        static constexpr auto extracts() -> bool {
+            for (const auto name : Method::parameters()) {
+                if (!detail::declares(segments, name)) return false;
+            }
+
+            return true;
+        }
+
+        static_assert(Path.str().starts_with('/'), "route must begin with '/'");
+        static_assert(detail::valid(segments), "invalid route parameter");
+        static_assert(
+            (extracts<Methods>() && ...),
+            "handler extracts a path parameter the route does not declare"
+        );
+
+        template <std::size_t I>
+        static auto match_segment(
+            std::string_view& rest,
+            bool& done,
+            route_table<method_router>::param_list& params
+        ) -> bool {
+            constexpr auto segment = segments[I];
+
+            if (done) return false;
+
+            if constexpr (segment.type == detail::segment_type::catch_all) {
+                params.push_back({segment.text, rest});
+                done = true;
+                return true;
+            }
+            else {
+                const auto slash = rest.find('/');
+                const auto text = rest.substr(0, slash);
+
+                if (slash == std::string_view::npos) done = true;
+                else rest.remove_prefix(slash + 1);
+
+                if constexpr (segment.type == detail::segment_type::param) {
+                    params.push_back({segment.text, text});
+                    return true;
+                }
+                else return text == segment.text;
+            }
+        }
+    public:
+        static constexpr auto path = detail::normalize(Path.str());
+
+        static constexpr auto dynamic = std::ranges::any_of(
+            segments,
+            [](const detail::segment& segment) {
+                return segment.type != detail::segment_type::literal;
+            }
+        );
+
+        static constexpr auto length = size;
+
+        template <std::size_t N>
+        static constexpr auto rank() -> std::array<int, N> {
+            auto result = std::array<int, N>();
+            result.fill(-1);
+
+            for (auto i = std::size_t(); i < size; ++i) {
+                result[i] = static_cast<int>(segments[i].type);
+            }
+
+            return result;
+        }
+
+        static auto handlers() -> method_router {
+            auto result = method_router();
+            (result.use(Methods::name, Methods::handler), ...);
+            return result;
+        }
+
+        static auto match(
+            std::string_view path,
+            route_table<method_router>::param_list& params
+        ) -> bool {
+            auto rest = path.substr(1);
+            auto done = path.size() <= 1;
+
+            return [&]<std::size_t... I>(std::index_sequence<I...>) {
+                return (match_segment<I>(rest, done, params) && ...) && done;
+            }(std::make_index_sequence<size>());
+        }
+    };
+
+    template <typename... Routes>
+    class table {
+        static constexpr auto count = sizeof...(Routes);
+
+        static constexpr auto paths =
+            std::array<std::string_view, count> {Routes::path...};
+
+        static constexpr auto dynamic =
+            std::array<bool, count> {Routes::dynamic...};
+
+        static constexpr auto statics =
+            static_cast<std::size_t>(std::ranges::count(dynamic, false));
+
+        // Indices of the routes without parameters, in declaration order.
+        static constexpr auto static_routes = [] {
+            auto result = std::array<std::uint32_t, statics>();
+            auto size = std::size_t();
+
+            for (auto i = std::size_t(); i < count; ++i) {
+                if (!dynamic[i]) result[size++] = static_cast<std::uint32_t>(i);
+            }
+
+            return result;
+        }();
+
+        static constexpr auto hash = [] {
+            auto keys = std::array<std::string_view, statics>();
+
+            for (auto i = std::size_t(); i < statics; ++i) {
+                keys[i] = paths[static_routes[i]];
+            }
+
+            return detail::make_perfect_hash(keys);
+        }();
+
+        static_assert(!hash.duplicate, "duplicate route");
+        static_assert(hash.complete, "no perfect hash for static routes");
+
+        static constexpr auto length =
+            std::max({std::size_t(), Routes::length...});
+
+        // Routes with parameters are tried with literal segments taking
+        // precedence over parameters, and parameters over catch-alls.
+        static constexpr auto order = [] {
+            const auto ranks = std::array<std::array<int, length>, count> {
+                Routes::template rank<length>()...};
+
+            auto result = std::array<std::uint32_t, count>();
+            auto size = std::size_t();
+
+            for (auto i = std::size_t(); i < count; ++i) {
+                if (!dynamic[i]) continue;
+
+                auto j = size++;
+                while (j > 0 && ranks[i] < ranks[result[j - 1]]) {
+                    result[j] = result[j - 1];
+                    --j;
+                }
+
+                result[j] = static_cast<std::uint32_t>(i);
+            }
+
+            for (auto i = size; i < count; ++i) result[i] = detail::none;
+
+            return result;
+        }();
+
+        template <std::size_t I>
+        static auto try_route(
+            std::string_view path,
+            route_table<method_router>::param_list& params,
+            std::uint32_t& found
+        ) -> bool {
+            if constexpr (order[I] == detail::none) return false;
+            else {
+                using route = std::tuple_element_t<
+                    order[I],
+                    std::tuple<Routes...>>;
+
+                params.resize(0);
+                if (!route::match(path, params)) return false;
+
+                found = order[I];
+                return true;
+            }
+        }
+    public:
+        static auto find(std::string_view path, std::span<method_router> values)
+            -> std::optional<route_table<method_router>::match> {
+            path = detail::normalize(path);
+
+            auto result = route_table<method_router>::match {.value = nullptr};
+
+            if constexpr (statics > 0) {
+                const auto key = hash.find(path);
+
+                if (key != detail::none && paths[static_routes[key]] == path) {
+                    result.value = &values[static_routes[key]];
+                    return result;
+                }
+            }
+
+            if (!path.starts_with('/')) return std::nullopt;
+
+            auto found = detail::none;
+
+            const auto matched = [&]<std::size_t... I>(
+                                     std::index_sequence<I...>
+                                 ) {
+                return (try_route<I>(path, result.params, found) || ...);
+            }(std::make_index_sequence<count>());
+
+            if (!matched) return std::nullopt;
+
+            result.value = &values[found];
+            return result;
+        }
+
+        static auto handlers() -> std::vector<method_router> {
+            auto result = std::vector<method_router>();
+            result.reserve(count);
+
+            (result.push_back(Routes::handlers()), ...);
+
+            return result;
+        }
+    };
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <sys/uio.h>
+#include <vector>
+
+namespace http::server {
+    class send_batch {
+        struct segment {
+            const std::byte* data;
+            std::size_t offset;
+            std::size_t size;
+        };
+
+        std::vector<std::byte> storage;
+        std::vector<segment> segments;
+        std::vector<iovec> vectors;
+        std::size_t bytes = 0;
+    public:
+        auto append(const void* data, std::size_t size) -> void;
+
+        auto clear() noexcept -> void;
+
+        auto empty() const noexcept -> bool;
+
+        auto iov() -> std::span<iovec>;
+
+        auto reference(const void* data, std::size_t size) -> void;
+
+        auto size() const noexcept -> std::size_t;
+    };
+}
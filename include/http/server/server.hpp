@@ -1,15 +1,39 @@
 #pragma once
 
+#include "admission.hpp"
+#include "http1/session.hpp"
+#include "metrics.hpp"
+#include "options.hpp"
 #include "router.hpp"
 #include "session.hpp"
 
 #include <netcore/netcore>
 
 namespace http::server {
+    namespace detail {
+        struct option_deleter {
+            auto operator()(nghttp2_option* option) const noexcept -> void;
+        };
+    }
+
     class context {
-        const std::size_t buffer_size;
+        const server::options options;
+        std::unique_ptr<nghttp2_option, detail::option_deleter> option;
         server::router* router;
+        server::counters counters;
+        std::shared_ptr<concurrency_limit> admission;
         session sessions;
+        http1::session http1_sessions;
+        std::optional<netcore::timer> deadline;
+        bool draining = false;
+
+        auto connection_closed() -> void;
+
+        auto drain() -> ext::detached_task;
+
+        auto serve_http1(server::socket&& socket) -> ext::task<>;
+
+        auto serve_http2(server::socket&& socket) -> ext::task<>;
     public:
         context();
 
@@ -17,12 +41,27 @@ namespace http::server {
 
         context(server::router& router, std::size_t buffer_size);
 
+        context(server::router& router, const server::options& options);
+
+        context(
+            server::router& router,
+            const server::options& options,
+            std::shared_ptr<concurrency_limit> admission
+        );
+
+        auto connection(netcore::socket&& client) -> ext::task<>;
+
         auto connection(netcore::ssl::socket&& client) -> ext::task<>;
 
+        auto metrics() const noexcept -> server::metrics;
+
         auto shutdown() -> void;
     };
 
     using ssl_context = netcore::ssl::server<context>;
     using server = netcore::server<ssl_context>;
     using server_list = netcore::server_list<ssl_context>;
+
+    using h2c_server = netcore::server<context>;
+    using h2c_server_list = netcore::server_list<context>;
 }
@@ -1,48 +1,115 @@
 #pragma once
 
+#include "admission.hpp"
+#include "metrics.hpp"
+#include "options.hpp"
 #include "router.hpp"
+#include "send_batch.hpp"
+#include "socket.hpp"
+#include "timer_wheel.hpp"
 
+#include <memory_resource>
 #include <netcore/netcore>
 #include <nghttp2/nghttp2.h>
 
 namespace http::server {
+    namespace detail {
+        auto change_priority(
+            nghttp2_session* session,
+            const http2_settings& settings,
+            std::int32_t stream_id,
+            const priority& priority
+        ) -> int;
+
+        auto settings(const http2_settings& values)
+            -> std::vector<nghttp2_settings_entry>;
+    }
+
     class session {
         friend struct fmt::formatter<session>;
 
+        struct file_frame {
+            std::array<std::uint8_t, 9> header;
+            int fd;
+            std::size_t offset;
+            std::size_t length;
+        };
+
         session* next = this;
         session* prev = this;
 
+        std::pmr::unsynchronized_pool_resource memory;
         stream streams;
+        stream retired;
+        stream pool;
+        std::size_t pooled = 0;
         nghttp2_session* handle = nullptr;
-        netcore::ssl::buffered_socket socket;
+        server::socket socket;
+        http2_options http2;
+        send_options batching;
+        limit_options limits;
+        timeout_options timeouts;
+        send_batch batch;
+        std::optional<file_frame> pending_file;
+        std::vector<nghttp2_nv> nva;
+        std::vector<body_writer*> drained;
+        std::vector<body_writer*> resuming;
         http::server::router* router = nullptr;
+        server::counters* counters = nullptr;
+        concurrency_limit* admission = nullptr;
         ext::counter tasks;
         ext::continuation<> closed;
         ext::continuation<> send;
         ext::jtask<> send_task;
+        server::timeout idle_timeout;
+        bool draining = false;
 
         auto await_close() -> ext::task<>;
 
         auto idle() const noexcept -> bool;
 
+        auto oversized(const stream& stream) const noexcept -> bool;
+
+        auto discard_body(stream& stream) -> void;
+
+        auto produce(stream& stream, streaming_body& body) -> ext::task<>;
+
+        auto pump(stream& stream) -> pooled_detached_task;
+
         auto recv() -> ext::task<>;
 
-        auto respond(stream& stream) -> ext::task<>;
+        auto recycle_retired() noexcept -> void;
+
+        auto refuse(stream& stream) -> void;
+
+        auto respond(stream& stream) -> pooled_task<>;
+
+        auto resume_producers() -> bool;
+
+        auto flush_batch() -> ext::task<>;
+
+        auto handle_request(stream& stream, concurrency_limit::permit permit)
+            -> pooled_detached_task;
+
+        auto goaway() -> void;
 
         auto send_server_connection_header() -> void;
 
         auto start_send() -> ext::jtask<>;
 
+        auto time_out(stream& stream) -> void;
+
         auto unlink() noexcept -> void;
     public:
-        ext::continuation<>* pause = nullptr;
-
         session() = default;
 
         session(
-            netcore::ssl::socket&& socket,
-            std::size_t buffer_size,
-            http::server::router& router
+            server::socket&& socket,
+            const server::options& options,
+            const nghttp2_option* option,
+            http::server::router& router,
+            server::counters& counters,
+            concurrency_limit* admission
         );
 
         session(const session&) = delete;
@@ -55,15 +122,48 @@ namespace http::server {
 
         auto operator=(session&&) -> session& = delete;
 
+        auto can_sendfile() const noexcept -> bool;
+
         auto close() noexcept -> void;
 
+        auto close_stream(stream& stream) noexcept -> void;
+
+        auto consume(stream& stream, std::size_t length) -> void;
+
+        auto deliver(stream& stream) -> void;
+
+        auto drain() noexcept -> void;
+
+        auto drain(body_writer& writer) -> void;
+
         auto handle_connection() -> ext::task<>;
 
-        auto handle_request(stream& stream) -> ext::detached_task;
+        auto dispatch(stream& stream) -> void;
 
         auto link(session& other) noexcept -> void;
 
         auto make_stream(std::int32_t id) -> stream&;
+
+        auto recv_header(
+            stream& stream,
+            nghttp2_rcbuf* name,
+            nghttp2_rcbuf* value
+        ) -> void;
+
+        auto refresh_timeout(stream& stream) -> void;
+
+        auto send_data(
+            const std::uint8_t* header,
+            const void* data,
+            std::size_t length
+        ) -> void;
+
+        auto send_file(
+            const std::uint8_t* header,
+            const file& file,
+            std::size_t offset,
+            std::size_t length
+        ) -> void;
     };
 }
 
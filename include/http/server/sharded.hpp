@@ -0,0 +1,52 @@
+#pragma once
+
+#include "metrics.hpp"
+#include "options.hpp"
+#include "router.hpp"
+
+#include <memory>
+#include <netcore/netcore>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+namespace http::server {
+    struct shard_options {
+        std::string host = "0.0.0.0";
+        std::uint16_t port = 0;
+        unsigned int shards = 0;
+        bool pin = true;
+        int backlog = SOMAXCONN;
+    };
+
+    class sharded_server {
+        struct shard;
+
+        std::vector<std::unique_ptr<shard>> shards;
+    public:
+        sharded_server(
+            http::server::router& router,
+            const http::server::options& options,
+            const shard_options& shard_options,
+            const netcore::ssl::context* ssl = nullptr
+        );
+
+        sharded_server(const sharded_server&) = delete;
+
+        sharded_server(sharded_server&&) = delete;
+
+        ~sharded_server();
+
+        auto operator=(const sharded_server&) -> sharded_server& = delete;
+
+        auto operator=(sharded_server&&) -> sharded_server& = delete;
+
+        auto metrics() const noexcept -> http::server::metrics;
+
+        auto shutdown() noexcept -> void;
+
+        auto size() const noexcept -> std::size_t;
+
+        auto wait() -> void;
+    };
+}
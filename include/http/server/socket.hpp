@@ -0,0 +1,66 @@
+#pragma once
+
+#include <netcore/netcore>
+#include <sys/uio.h>
+#include <variant>
+
+namespace http::server {
+    class socket {
+        friend struct fmt::formatter<socket>;
+
+        std::variant<netcore::buffered_socket, netcore::ssl::buffered_socket>
+            inner;
+        bool ktls = false;
+        bool corked = false;
+
+        auto fd() const noexcept -> int;
+
+        auto flush() -> ext::task<>;
+
+        auto set_cork(bool enabled) noexcept -> void;
+
+        auto wait_for_write() -> ext::task<>;
+    public:
+        socket() = default;
+
+        socket(netcore::socket&& socket, std::size_t buffer_size);
+
+        socket(netcore::ssl::socket&& socket, std::size_t buffer_size);
+
+        auto can_sendfile() const noexcept -> bool;
+
+        auto cork() noexcept -> void;
+
+        auto encrypted() const noexcept -> bool;
+
+        auto read() -> ext::task<std::span<const std::byte>>;
+
+        auto sendfile(int fd, std::size_t offset, std::size_t count)
+            -> ext::task<>;
+
+        auto shutdown() -> void;
+
+        auto uncork() noexcept -> void;
+
+        auto write(std::span<iovec> iov) -> ext::task<>;
+    };
+}
+
+template <>
+struct fmt::formatter<http::server::socket> : formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(const http::server::socket& socket, FormatContext& ctx) {
+        auto buffer = memory_buffer();
+        auto out = std::back_inserter(buffer);
+
+        std::visit(
+            [&](const auto& inner) { fmt::format_to(out, "{}", inner); },
+            socket.inner
+        );
+
+        return formatter<std::string_view>::format(
+            {buffer.data(), buffer.size()},
+            ctx
+        );
+    }
+};
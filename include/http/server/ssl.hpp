@@ -3,5 +3,7 @@
 #include <netcore/netcore>
 
 namespace http::server {
+    auto enable_ktls(netcore::ssl::context& context) -> bool;
+
     auto ssl() -> netcore::ssl::context;
 }
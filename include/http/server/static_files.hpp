@@ -0,0 +1,21 @@
+#pragma once
+
+#include "method_router.hpp"
+
+#include <filesystem>
+
+namespace http::server {
+    struct static_options {
+        std::string index = "index.html";
+        std::string param = "path";
+        std::string cache_control;
+        std::size_t max_entries = 1024;
+    };
+
+    auto media_type_for(std::string_view path) noexcept -> std::string_view;
+
+    auto static_files(
+        const std::filesystem::path& root,
+        const static_options& options = {}
+    ) -> method_router;
+}
@@ -2,9 +2,15 @@
 
 #include "request.hpp"
 #include "response.hpp"
+#include "timer_wheel.hpp"
 
+#include <array>
 #include <fmt/format.h>
 #include <memory>
+#include <memory_resource>
+#include <vector>
+
+struct nghttp2_rcbuf;
 
 namespace http::server {
     namespace detail {
@@ -19,9 +25,9 @@ namespace http::server {
     class stream {
         stream* next = this;
         stream* prev = this;
-        std::unique_ptr<const char[]> path_storage;
-
-        auto process_path(std::string_view path) -> void;
+        std::array<std::byte, 2048> initial_buffer;
+        std::pmr::monotonic_buffer_resource arena;
+        std::vector<nghttp2_rcbuf*> buffers;
 
         auto process_query(
             std::string_view query,
@@ -29,19 +35,38 @@ namespace http::server {
             std::size_t pos
         ) -> void;
 
+        auto release() noexcept -> void;
+
         auto unlink() noexcept -> void;
     public:
-        const std::int32_t id;
+        std::int32_t id;
 
         bool active = false;
         bool open = true;
 
+        // Request body bytes copied out of nghttp2's buffers. The peer can
+        // only send as much as the stream window allows, and the window is
+        // reopened as the handler reads.
+        std::vector<std::byte> inbox;
+        std::vector<std::byte> held;
+        std::size_t unconsumed = 0;
+        std::size_t received = 0;
+        bool ended = false;
+        bool pumping = false;
+        bool rejected = false;
+
+        std::size_t header_count = 0;
+        std::size_t header_size = 0;
+
+        server::timeout read_timeout;
+        server::timeout handler_timeout;
+
         server::request request;
         server::response response;
 
         stream();
 
-        stream(std::int32_t id);
+        stream(std::int32_t id, std::pmr::memory_resource* upstream);
 
         stream(const stream&) = delete;
 
@@ -53,13 +78,25 @@ namespace http::server {
 
         auto operator=(stream&&) -> stream& = delete;
 
+        auto abort() noexcept -> void;
+
+        auto clear() noexcept -> void;
+
         auto delete_all() noexcept -> void;
 
         auto empty() const noexcept -> bool;
 
         auto link(stream& other) noexcept -> void;
 
-        auto recv_header(std::string_view name, std::string_view value) -> void;
+        auto pop() noexcept -> stream*;
+
+        auto recv_header(nghttp2_rcbuf* name, nghttp2_rcbuf* value) -> void;
+
+        auto recv_path(std::string_view path) -> void;
+
+        auto set_header(std::string_view name, std::string_view value) -> void;
+
+        auto store(std::string_view string) -> std::string_view;
     };
 }
 
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ext/coroutine>
+#include <functional>
+
+namespace http::server {
+    class timer_wheel;
+
+    class timeout {
+        friend class timer_wheel;
+
+        timeout* next = this;
+        timeout* prev = this;
+        timer_wheel* wheel = nullptr;
+        std::uint64_t expiry = 0;
+        std::function<void()> callback;
+
+        auto link(timeout& other) noexcept -> void;
+
+        auto unlink() noexcept -> void;
+    public:
+        timeout() = default;
+
+        explicit timeout(std::function<void()>&& callback);
+
+        timeout(const timeout&) = delete;
+
+        timeout(timeout&&) = delete;
+
+        ~timeout();
+
+        auto operator=(const timeout&) -> timeout& = delete;
+
+        auto operator=(timeout&&) -> timeout& = delete;
+
+        auto arm(std::chrono::milliseconds duration) -> void;
+
+        auto arm(timer_wheel& wheel, std::chrono::milliseconds duration)
+            -> void;
+
+        auto armed() const noexcept -> bool;
+
+        auto cancel() noexcept -> void;
+
+        auto set_callback(std::function<void()>&& callback) -> void;
+    };
+
+    class timer_wheel {
+        static constexpr auto bits = 6u;
+        static constexpr auto levels = 4u;
+        static constexpr auto slots = 1u << bits;
+
+        std::array<std::array<timeout, slots>, levels> wheel;
+        std::uint64_t now = 0;
+        std::size_t count = 0;
+        bool driven = false;
+        bool running = false;
+
+        auto cascade(unsigned int level) -> void;
+
+        auto run() -> ext::detached_task;
+
+        auto schedule(timeout& timeout) noexcept -> void;
+    public:
+        static constexpr auto resolution = std::chrono::milliseconds(100);
+
+        static auto local() -> timer_wheel&;
+
+        explicit timer_wheel(bool driven = false);
+
+        timer_wheel(const timer_wheel&) = delete;
+
+        timer_wheel(timer_wheel&&) = delete;
+
+        auto operator=(const timer_wheel&) -> timer_wheel& = delete;
+
+        auto operator=(timer_wheel&&) -> timer_wheel& = delete;
+
+        auto add(timeout& timeout, std::chrono::milliseconds duration)
+            -> void;
+
+        auto remove(timeout& timeout) noexcept -> void;
+
+        auto size() const noexcept -> std::size_t;
+
+        auto tick() -> void;
+    };
+}
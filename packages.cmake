@@ -4,8 +4,13 @@ find_package(PkgConfig REQUIRED)
 cmake_policy(PUSH)
 cmake_policy(SET CMP0150 NEW)
 
+pkg_check_modules(BROTLI REQUIRED libbrotlienc)
 pkg_check_modules(CURL REQUIRED libcurl)
-pkg_check_modules(NGHTTP2 REQUIRED libnghttp2)
+pkg_check_modules(NGHTTP2 REQUIRED libnghttp2>=1.50)
+pkg_check_modules(ZLIB REQUIRED zlib)
+pkg_check_modules(ZSTD REQUIRED libzstd)
+
+find_package(Threads REQUIRED)
 
 FetchContent_Declare(ext
     GIT_REPOSITORY ../libext.git
@@ -0,0 +1,111 @@
+#include <http/server/admission.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Each slow response takes 1% off the limit, so that a limit's worth of
+    // slow responses cuts it roughly in half.
+    constexpr auto backoff_ratio = 0.99;
+}
+
+namespace http::server {
+    auto admit(concurrency_limit* limit) noexcept
+        -> std::optional<concurrency_limit::permit> {
+        if (!limit) return concurrency_limit::permit();
+        return limit->acquire();
+    }
+
+    concurrency_limit::permit::permit(concurrency_limit& owner) :
+        owner(&owner),
+        start(std::chrono::steady_clock::now()) {}
+
+    concurrency_limit::permit::permit(permit&& other) noexcept :
+        owner(std::exchange(other.owner, nullptr)),
+        start(other.start) {}
+
+    concurrency_limit::permit::~permit() { release(); }
+
+    auto concurrency_limit::permit::operator=(permit&& other) noexcept
+        -> permit& {
+        if (std::addressof(other) != this) {
+            release();
+
+            owner = std::exchange(other.owner, nullptr);
+            start = other.start;
+        }
+
+        return *this;
+    }
+
+    auto concurrency_limit::permit::release(
+        std::chrono::steady_clock::duration waiting
+    ) noexcept -> void {
+        if (!owner) return;
+
+        // Time spent waiting on the client for the request body says nothing
+        // about how loaded the server is.
+        const auto latency =
+            std::chrono::steady_clock::now() - start - waiting;
+        std::exchange(owner, nullptr)->release(latency);
+    }
+
+    concurrency_limit::concurrency_limit(const admission_options& options) :
+        options(options),
+        current(static_cast<double>(
+            std::clamp(options.limit, options.min_limit, options.max_limit)
+        )) {}
+
+    auto concurrency_limit::acquire() noexcept -> std::optional<permit> {
+        auto count = in_flight.load(std::memory_order_relaxed);
+
+        do {
+            if (count >= limit()) return std::nullopt;
+        } while (!in_flight.compare_exchange_weak(
+            count,
+            count + 1,
+            std::memory_order_relaxed
+        ));
+
+        return permit(*this);
+    }
+
+    auto concurrency_limit::limit() const noexcept -> std::size_t {
+        return static_cast<std::size_t>(
+            current.load(std::memory_order_relaxed)
+        );
+    }
+
+    auto concurrency_limit::release(
+        std::chrono::steady_clock::duration latency
+    ) noexcept -> void {
+        const auto count = in_flight.fetch_sub(1, std::memory_order_relaxed);
+
+        if (!options.target_latency) return;
+
+        const auto slow = latency > *options.target_latency;
+        const auto min = static_cast<double>(options.min_limit);
+        const auto max = static_cast<double>(options.max_limit);
+
+        auto value = current.load(std::memory_order_relaxed);
+        auto next = value;
+
+        do {
+            // Only grow while the limit is actually being used; otherwise
+            // it drifts up without evidence that more work can be handled.
+            if (slow) next = std::max(min, value * backoff_ratio);
+            else if (count * 2 >= value) {
+                next = std::min(max, value + 1 / value);
+            }
+            else return;
+        } while (!current.compare_exchange_weak(
+            value,
+            next,
+            std::memory_order_relaxed
+        ));
+    }
+
+    auto concurrency_limit::size() const noexcept -> std::size_t {
+        return in_flight.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,89 @@
+#include <http/server/admission.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace std::literals;
+
+using http::server::admission_options;
+using http::server::concurrency_limit;
+
+TEST(ConcurrencyLimit, Refuse) {
+    auto limit = concurrency_limit(admission_options {
+        .limit = 2,
+        .min_limit = 1,
+        .max_limit = 2,
+        .target_latency = std::nullopt,
+    });
+
+    auto first = limit.acquire();
+    auto second = limit.acquire();
+
+    EXPECT_TRUE(first);
+    EXPECT_TRUE(second);
+    EXPECT_FALSE(limit.acquire());
+    EXPECT_EQ(2, limit.size());
+
+    first->release();
+    EXPECT_EQ(1, limit.size());
+    EXPECT_TRUE(limit.acquire());
+    EXPECT_EQ(1, limit.size());
+}
+
+TEST(ConcurrencyLimit, Shrink) {
+    auto limit = concurrency_limit(admission_options {
+        .limit = 4,
+        .min_limit = 3,
+        .max_limit = 8,
+        .target_latency = 0ms,
+    });
+
+    for (auto i = 0; i < 100; ++i) limit.acquire();
+
+    EXPECT_EQ(3, limit.limit());
+    EXPECT_EQ(0, limit.size());
+}
+
+TEST(ConcurrencyLimit, IgnoreWaiting) {
+    auto limit = concurrency_limit(admission_options {
+        .limit = 4,
+        .min_limit = 3,
+        .max_limit = 8,
+        .target_latency = 0ms,
+    });
+
+    for (auto i = 0; i < 100; ++i) limit.acquire()->release(1h);
+
+    EXPECT_EQ(4, limit.limit());
+}
+
+TEST(ConcurrencyLimit, Disabled) {
+    auto limit = concurrency_limit(admission_options {
+        .limit = 4,
+        .min_limit = 1,
+    });
+
+    for (auto i = 0; i < 100; ++i) limit.acquire();
+
+    EXPECT_EQ(4, limit.limit());
+}
+
+TEST(ConcurrencyLimit, Clamp) {
+    const auto limit = concurrency_limit(admission_options {
+        .limit = 100,
+        .min_limit = 1,
+        .max_limit = 10,
+    });
+
+    EXPECT_EQ(10, limit.limit());
+}
+
+TEST(ConcurrencyLimit, Unlimited) {
+    auto permits = std::vector<concurrency_limit::permit>();
+
+    for (auto i = 0; i < 10'000; ++i) {
+        auto permit = http::server::admit(nullptr);
+        ASSERT_TRUE(permit);
+
+        permits.push_back(std::move(*permit));
+    }
+}
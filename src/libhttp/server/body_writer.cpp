@@ -0,0 +1,69 @@
+#include <http/error.h>
+#include <http/server/body_writer.hpp>
+
+#include <utility>
+
+namespace http::server {
+    auto body_writer::abort() noexcept -> void {
+        aborted = true;
+
+        if (drained) {
+            drained.resume(std::make_exception_ptr(stream_aborted()));
+        }
+    }
+
+    auto body_writer::consume(std::size_t size) noexcept -> bool {
+        offset += size;
+        return offset == chunk.size();
+    }
+
+    auto body_writer::defer() noexcept -> void { deferred = true; }
+
+    auto body_writer::done() const noexcept -> bool {
+        return finished && pending().empty();
+    }
+
+    auto body_writer::finish() -> void {
+        finished = true;
+        if (!aborted && notify) notify();
+    }
+
+    auto body_writer::pending() const noexcept -> std::string_view {
+        return std::string_view(chunk).substr(offset);
+    }
+
+    auto body_writer::resume() noexcept -> void {
+        // The chunk may be consumed before the producer starts waiting.
+        if (drained) drained.resume();
+        else flushed = true;
+    }
+
+    auto body_writer::set_notify(std::function<void()>&& notify) -> void {
+        this->notify = std::move(notify);
+    }
+
+    auto body_writer::set_sink(sink_type&& sink) -> void {
+        this->sink = std::move(sink);
+    }
+
+    auto body_writer::take_deferred() noexcept -> bool {
+        return std::exchange(deferred, false);
+    }
+
+    auto body_writer::write(std::string_view data) -> ext::task<> {
+        if (aborted) throw stream_aborted();
+        if (data.empty()) co_return;
+
+        if (sink) {
+            co_await sink(data);
+            co_return;
+        }
+
+        chunk.assign(data);
+        offset = 0;
+        flushed = false;
+
+        if (notify) notify();
+        if (!flushed) co_await drained;
+    }
+}
@@ -0,0 +1,651 @@
+#include <http/server/compression.hpp>
+
+#include <brotli/encode.h>
+#include <ext/string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <zstd.h>
+
+using namespace std::literals;
+
+namespace {
+    using http::server::compression_options;
+    using http::server::content_coding;
+
+    constexpr auto chunk_size = std::size_t(16 * 1024);
+
+    // Server preference when the client weighs several codings equally.
+    constexpr auto preferred = std::array {
+        content_coding::zstd,
+        content_coding::br,
+        content_coding::gzip,
+    };
+
+    class compressor {
+    public:
+        enum class mode { process, flush, finish };
+
+        virtual ~compressor() = default;
+
+        virtual auto run(std::string_view input, std::string& output, mode mode)
+            -> void = 0;
+    };
+
+    class brotli_compressor final : public compressor {
+        BrotliEncoderState* state;
+    public:
+        brotli_compressor(int quality) :
+            state(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr)) {
+            if (!state) {
+                throw std::runtime_error("Failed to create brotli encoder");
+            }
+
+            BrotliEncoderSetParameter(state, BROTLI_PARAM_QUALITY, quality);
+        }
+
+        ~brotli_compressor() { BrotliEncoderDestroyInstance(state); }
+
+        auto run(std::string_view input, std::string& output, mode mode)
+            -> void override {
+            const auto op = mode == mode::process ? BROTLI_OPERATION_PROCESS
+                          : mode == mode::flush   ? BROTLI_OPERATION_FLUSH
+                                                  : BROTLI_OPERATION_FINISH;
+
+            auto available_in = input.size();
+            const auto* next_in =
+                reinterpret_cast<const std::uint8_t*>(input.data());
+
+            do {
+                const auto offset = output.size();
+                output.resize(offset + chunk_size);
+
+                auto available_out = chunk_size;
+                auto* next_out =
+                    reinterpret_cast<std::uint8_t*>(output.data() + offset);
+
+                if (!BrotliEncoderCompressStream(
+                        state,
+                        op,
+                        &available_in,
+                        &next_in,
+                        &available_out,
+                        &next_out,
+                        nullptr
+                    )) {
+                    throw std::runtime_error("Brotli compression failed");
+                }
+
+                output.resize(offset + chunk_size - available_out);
+            } while (available_in > 0 || BrotliEncoderHasMoreOutput(state));
+        }
+    };
+
+    class gzip_compressor final : public compressor {
+        z_stream stream = {};
+    public:
+        gzip_compressor(int level) {
+            // A window of 15 bits plus 16 selects the gzip wrapper.
+            const auto ret = deflateInit2(
+                &stream,
+                level,
+                Z_DEFLATED,
+                15 + 16,
+                8,
+                Z_DEFAULT_STRATEGY
+            );
+
+            if (ret != Z_OK) {
+                throw std::runtime_error("Failed to create gzip encoder");
+            }
+        }
+
+        ~gzip_compressor() { deflateEnd(&stream); }
+
+        auto run(std::string_view input, std::string& output, mode mode)
+            -> void override {
+            const auto flush = mode == mode::process ? Z_NO_FLUSH
+                             : mode == mode::flush   ? Z_SYNC_FLUSH
+                                                     : Z_FINISH;
+
+            stream.next_in =
+                reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+            stream.avail_in = input.size();
+
+            while (true) {
+                const auto offset = output.size();
+                output.resize(offset + chunk_size);
+
+                stream.next_out =
+                    reinterpret_cast<Bytef*>(output.data()) + offset;
+                stream.avail_out = chunk_size;
+
+                const auto ret = deflate(&stream, flush);
+                if (ret == Z_STREAM_ERROR) {
+                    throw std::runtime_error("Gzip compression failed");
+                }
+
+                output.resize(offset + chunk_size - stream.avail_out);
+
+                if (flush == Z_FINISH ? ret == Z_STREAM_END
+                                      : stream.avail_out != 0) {
+                    break;
+                }
+            }
+        }
+    };
+
+    class zstd_compressor final : public compressor {
+        ZSTD_CCtx* context;
+    public:
+        zstd_compressor(int level) : context(ZSTD_createCCtx()) {
+            if (!context) {
+                throw std::runtime_error("Failed to create zstd encoder");
+            }
+
+            ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, level);
+        }
+
+        ~zstd_compressor() { ZSTD_freeCCtx(context); }
+
+        auto run(std::string_view input, std::string& output, mode mode)
+            -> void override {
+            const auto directive = mode == mode::process ? ZSTD_e_continue
+                                 : mode == mode::flush   ? ZSTD_e_flush
+                                                         : ZSTD_e_end;
+
+            auto in = ZSTD_inBuffer {input.data(), input.size(), 0};
+
+            while (true) {
+                const auto offset = output.size();
+                output.resize(offset + chunk_size);
+
+                auto out =
+                    ZSTD_outBuffer {output.data() + offset, chunk_size, 0};
+
+                const auto remaining =
+                    ZSTD_compressStream2(context, &out, &in, directive);
+
+                if (ZSTD_isError(remaining)) {
+                    throw std::runtime_error(fmt::format(
+                        "Zstd compression failed: {}",
+                        ZSTD_getErrorName(remaining)
+                    ));
+                }
+
+                output.resize(offset + out.pos);
+
+                if (directive == ZSTD_e_continue ? in.pos == in.size
+                                                 : remaining == 0) {
+                    break;
+                }
+            }
+        }
+    };
+
+    using weights = std::array<int, 4>;
+
+    auto enabled(content_coding coding, const compression_options& options)
+        -> bool {
+        switch (coding) {
+            case content_coding::identity: return false;
+            case content_coding::gzip: return options.gzip;
+            case content_coding::br: return options.brotli;
+            case content_coding::zstd: return options.zstd;
+        }
+
+        return false;
+    }
+
+    auto eligible(int status) noexcept -> bool {
+        return status >= 200 && status != 204 && status != 206 &&
+               status != 304;
+    }
+
+    auto iequals(std::string_view a, std::string_view b) noexcept -> bool {
+        return std::ranges::equal(a, b, [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) ==
+                   std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    auto compressible(std::string_view type) noexcept -> bool {
+        type = ext::trim(type.substr(0, type.find(';')));
+
+        if (type.size() > 5 && iequals(type.substr(0, 5), "text/")) {
+            return true;
+        }
+
+        for (const auto suffix : {"+json"sv, "+xml"sv}) {
+            if (type.size() > suffix.size() &&
+                iequals(type.substr(type.size() - suffix.size()), suffix)) {
+                return true;
+            }
+        }
+
+        for (const auto candidate :
+             {"application/javascript"sv,
+              "application/json"sv,
+              "application/wasm"sv,
+              "application/xml"sv,
+              "image/svg+xml"sv}) {
+            if (iequals(type, candidate)) return true;
+        }
+
+        return false;
+    }
+
+    auto make_compressor(
+        content_coding coding,
+        const compression_options& options
+    ) -> std::unique_ptr<compressor> {
+        switch (coding) {
+            case content_coding::gzip:
+                return std::make_unique<gzip_compressor>(options.gzip_level);
+            case content_coding::br:
+                return std::make_unique<brotli_compressor>(
+                    options.brotli_quality
+                );
+            case content_coding::zstd:
+                return std::make_unique<zstd_compressor>(options.zstd_level);
+            default: throw std::invalid_argument("Unsupported content coding");
+        }
+    }
+
+    auto parse_weight(std::string_view params) noexcept -> std::optional<int> {
+        for (const auto param : ext::string_range(params, ";")) {
+            const auto value = ext::trim(param);
+            if (value.size() < 2 ||
+                std::tolower(static_cast<unsigned char>(value[0])) != 'q' ||
+                value[1] != '=') {
+                continue;
+            }
+
+            // qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+            const auto q = value.substr(2);
+            if (q.empty() || (q[0] != '0' && q[0] != '1')) return std::nullopt;
+
+            auto result = (q[0] - '0') * 1000;
+            auto scale = 100;
+
+            if (q.size() > 1) {
+                if (q[1] != '.' || q.size() > 5) return std::nullopt;
+
+                for (const auto c : q.substr(2)) {
+                    if (c < '0' || c > '9') return std::nullopt;
+                    if (q[0] == '1' && c != '0') return std::nullopt;
+
+                    result += (c - '0') * scale;
+                    scale /= 10;
+                }
+            }
+
+            return result;
+        }
+
+        return 1000;
+    }
+
+    auto parse_weights(std::string_view accept_encoding) -> weights {
+        auto result = weights {-1, -1, -1, -1};
+        auto wildcard = -1;
+
+        for (const auto item : ext::string_range(accept_encoding, ",")) {
+            const auto semicolon = item.find(';');
+            const auto name = ext::trim(item.substr(0, semicolon));
+
+            if (name.empty()) continue;
+
+            const auto weight = parse_weight(
+                semicolon == std::string_view::npos ? ""sv
+                                                    : item.substr(semicolon)
+            );
+
+            if (!weight) continue;
+
+            if (name == "*") wildcard = *weight;
+            else if (iequals(name, "gzip") || iequals(name, "x-gzip")) {
+                result[std::size_t(content_coding::gzip)] = *weight;
+            }
+            else if (iequals(name, "br")) {
+                result[std::size_t(content_coding::br)] = *weight;
+            }
+            else if (iequals(name, "zstd")) {
+                result[std::size_t(content_coding::zstd)] = *weight;
+            }
+        }
+
+        for (auto& weight : result) {
+            if (weight == -1) weight = std::max(wildcard, 0);
+        }
+
+        return result;
+    }
+
+    // A 304 carries the tag of the representation the client revalidated,
+    // which is encoded if an earlier response was.
+    auto revalidated(
+        const http::server::request& request,
+        http::server::header_list& headers,
+        const compression_options& options
+    ) -> void {
+        const auto* const etag = headers.find("etag");
+        const auto header = request.headers.find("if-none-match");
+
+        if (!etag || !etag->value.ends_with('"')) return;
+        if (header == request.headers.end()) return;
+
+        auto value = etag->value;
+        value.remove_suffix(1);
+
+        for (const auto coding : preferred) {
+            if (!enabled(coding, options)) continue;
+
+            const auto encoded =
+                fmt::format("{}-{}\"", value, http::server::to_string(coding));
+
+            for (const auto item : ext::string_range(header->second, ",")) {
+                auto tag = ext::trim(item);
+                if (tag.starts_with("W/")) tag.remove_prefix(2);
+
+                if (tag == encoded) {
+                    headers.set("etag", encoded);
+                    return;
+                }
+            }
+        }
+    }
+
+    auto select(
+        const weights& weights,
+        const compression_options& options,
+        const std::array<bool, 4>& available
+    ) -> content_coding {
+        auto result = content_coding::identity;
+        auto best = 0;
+
+        for (const auto coding : preferred) {
+            const auto index = std::size_t(coding);
+            const auto weight = weights[index];
+
+            if (weight > best && available[index] && enabled(coding, options)) {
+                result = coding;
+                best = weight;
+            }
+        }
+
+        return result;
+    }
+
+    auto tag(http::server::header_list& headers, content_coding coding)
+        -> void {
+        const auto* const etag = headers.find("etag");
+        if (!etag || !etag->value.ends_with('"')) return;
+
+        // Each encoding is a distinct representation with its own tag.
+        auto value = etag->value;
+        value.remove_suffix(1);
+
+        headers.set(
+            "etag",
+            fmt::format("{}-{}\"", value, http::server::to_string(coding))
+        );
+    }
+
+    auto vary(http::server::header_list& headers) -> void {
+        const auto* const field = headers.find("vary");
+
+        if (!field) {
+            headers.emplace("vary", "accept-encoding");
+            return;
+        }
+
+        for (const auto item : ext::string_range(field->value, ",")) {
+            const auto value = ext::trim(item);
+            if (value == "*" || iequals(value, "accept-encoding")) return;
+        }
+
+        headers.set("vary", fmt::format("{}, accept-encoding", field->value));
+    }
+
+    auto write_compressed(
+        compressor& encoder,
+        std::string& buffer,
+        std::string_view data,
+        http::server::body_writer& out
+    ) -> ext::task<> {
+        buffer.clear();
+        encoder.run(data, buffer, compressor::mode::flush);
+
+        co_await out.write(buffer);
+    }
+
+    auto compressed(
+        http::server::body_producer producer,
+        content_coding coding,
+        compression_options options,
+        http::server::body_writer& out
+    ) -> ext::task<> {
+        const auto encoder = make_compressor(coding, options);
+        auto buffer = std::string();
+        auto writer = http::server::body_writer();
+
+        // Each write is flushed through the encoder so that streamed data
+        // reaches the client as soon as it is produced.
+        writer.set_sink([&](std::string_view data) {
+            return write_compressed(*encoder, buffer, data, out);
+        });
+
+        co_await producer(writer);
+
+        buffer.clear();
+        encoder->run({}, buffer, compressor::mode::finish);
+
+        co_await out.write(buffer);
+    }
+
+    auto precompressed(
+        http::server::file& file,
+        const weights& weights,
+        const compression_options& options
+    ) -> content_coding {
+        if (const auto& encodings = file.encodings) {
+            auto available = std::array<bool, 4>();
+
+            for (auto i = std::size_t(); i < encodings->size(); ++i) {
+                available[i] = static_cast<bool>((*encodings)[i].fd);
+            }
+
+            const auto coding = select(weights, options, available);
+
+            if (coding != content_coding::identity) {
+                const auto& encoded = (*encodings)[std::size_t(coding)];
+
+                file.fd = netcore::fd();
+                file.shared = encoded.fd;
+                file.size = encoded.size;
+            }
+
+            return coding;
+        }
+
+        struct stat original;
+        if (fstat(file.descriptor(), &original) == -1 ||
+            static_cast<std::size_t>(original.st_size) != file.size) {
+            return content_coding::identity;
+        }
+
+        auto siblings = std::array<netcore::fd, 4>();
+        auto sizes = std::array<std::size_t, 4>();
+        auto available = std::array<bool, 4>();
+
+        for (const auto coding : preferred) {
+            const auto index = std::size_t(coding);
+            if (weights[index] <= 0 || !enabled(coding, options)) continue;
+
+            const auto path = fmt::format(
+                "{}{}",
+                file.path,
+                http::server::extension(coding)
+            );
+            auto fd = netcore::fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+            if (!fd.valid()) continue;
+
+            struct stat sibling;
+            if (fstat(fd, &sibling) == -1 || !S_ISREG(sibling.st_mode)) {
+                continue;
+            }
+
+            // A sibling older than the original is stale.
+            if (sibling.st_mtim.tv_sec < original.st_mtim.tv_sec) continue;
+
+            siblings[index] = std::move(fd);
+            sizes[index] = sibling.st_size;
+            available[index] = true;
+        }
+
+        const auto coding = select(weights, options, available);
+
+        if (coding != content_coding::identity) {
+            const auto index = std::size_t(coding);
+
+            file.fd = std::move(siblings[index]);
+            file.shared.reset();
+            file.size = sizes[index];
+        }
+
+        return coding;
+    }
+}
+
+namespace http::server {
+    auto compress(
+        const request& request,
+        response& response,
+        const compression_options& options
+    ) -> void {
+        if (response.status == 304) {
+            vary(response.headers);
+            revalidated(request, response.headers, options);
+            return;
+        }
+
+        if (!eligible(response.status)) return;
+        if (response.headers.contains("content-encoding")) return;
+
+        const auto* const type = response.headers.find("content-type");
+        if (!type || !compressible(type->value)) return;
+
+        const auto accept = request.headers.find("accept-encoding");
+        const auto weights = parse_weights(
+            accept == request.headers.end() ? ""sv : accept->second
+        );
+
+        auto coding = content_coding::identity;
+
+        if (auto* const string = std::get_if<std::string>(&response.data)) {
+            // Strings are compressed in one go on the event loop thread.
+            if (string->size() < options.min_size ||
+                string->size() > options.max_size) {
+                return;
+            }
+
+            vary(response.headers);
+
+            coding = select(weights, options, {true, true, true, true});
+            if (coding == content_coding::identity) return;
+
+            auto result = compress(coding, *string, options);
+
+            // Not worth it: send the original instead.
+            if (result.size() >= string->size()) return;
+
+            *string = std::move(result);
+
+            response.headers.erase("content-length");
+            response.content_length(string->size());
+        }
+        else if (auto* const file = std::get_if<server::file>(&response.data)) {
+            // Siblings can only stand in for the whole file.
+            if (!options.precompressed || file->offset ||
+                (!file->encodings && file->path.empty())) {
+                return;
+            }
+
+            vary(response.headers);
+
+            coding = precompressed(*file, weights, options);
+            if (coding == content_coding::identity) return;
+
+            response.headers.erase("content-length");
+            response.content_length(file->size);
+        }
+        else if (auto* const body =
+                     std::get_if<streaming_body>(&response.data)) {
+            vary(response.headers);
+
+            coding = select(weights, options, {true, true, true, true});
+            if (coding == content_coding::identity) return;
+
+            body->producer = [producer = std::move(body->producer),
+                              coding,
+                              options](body_writer& out) {
+                return compressed(producer, coding, options, out);
+            };
+
+            response.headers.erase("content-length");
+        }
+        else return;
+
+        tag(response.headers, coding);
+        response.headers.emplace("content-encoding", to_string(coding));
+
+        // Ranges would refer to the identity representation.
+        response.headers.erase("accept-ranges");
+    }
+
+    auto compress(
+        content_coding coding,
+        std::string_view data,
+        const compression_options& options
+    ) -> std::string {
+        auto result = std::string();
+        result.reserve(data.size() / 2);
+
+        make_compressor(coding, options)
+            ->run(data, result, compressor::mode::finish);
+
+        return result;
+    }
+
+    auto extension(content_coding coding) noexcept -> std::string_view {
+        switch (coding) {
+            case content_coding::gzip: return ".gz";
+            case content_coding::br: return ".br";
+            case content_coding::zstd: return ".zst";
+            default: return "";
+        }
+    }
+
+    auto negotiate(
+        std::string_view accept_encoding,
+        const compression_options& options
+    ) -> content_coding {
+        return select(
+            parse_weights(accept_encoding),
+            options,
+            {true, true, true, true}
+        );
+    }
+
+    auto to_string(content_coding coding) noexcept -> std::string_view {
+        switch (coding) {
+            case content_coding::identity: return "identity";
+            case content_coding::gzip: return "gzip";
+            case content_coding::br: return "br";
+            case content_coding::zstd: return "zstd";
+        }
+
+        return "identity";
+    }
+}
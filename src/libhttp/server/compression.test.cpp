@@ -0,0 +1,127 @@
+#include <http/server/compression.hpp>
+#include <http/server/response/file.hpp>
+#include <http/server/response/string.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace std::literals;
+
+using http::server::content_coding;
+
+TEST(Compression, Negotiate) {
+    const auto options = http::server::compression_options();
+    const auto negotiate = [&](std::string_view accept) {
+        return http::server::negotiate(accept, options);
+    };
+
+    EXPECT_EQ(content_coding::identity, negotiate(""));
+    EXPECT_EQ(content_coding::identity, negotiate("identity"));
+    EXPECT_EQ(content_coding::gzip, negotiate("gzip"));
+    EXPECT_EQ(content_coding::gzip, negotiate("GZIP;q=0.5, identity"));
+    EXPECT_EQ(content_coding::zstd, negotiate("gzip, deflate, br, zstd"));
+    EXPECT_EQ(content_coding::br, negotiate("gzip;q=0.8, br"));
+    EXPECT_EQ(content_coding::zstd, negotiate("*"));
+    EXPECT_EQ(content_coding::gzip, negotiate("*, zstd;q=0, br;q=0"));
+    EXPECT_EQ(content_coding::identity, negotiate("gzip;q=0"));
+    EXPECT_EQ(content_coding::identity, negotiate("gzip;q=2"));
+    EXPECT_EQ(content_coding::gzip, negotiate("gzip;q=1.000"));
+    EXPECT_EQ(content_coding::identity, negotiate("gzip;q=1.5"));
+    EXPECT_EQ(content_coding::br, negotiate("gzip;q=1.001, br;q=0.5"));
+}
+
+TEST(Compression, NegotiateDisabled) {
+    const auto options =
+        http::server::compression_options {.brotli = false, .zstd = false};
+
+    EXPECT_EQ(
+        content_coding::gzip,
+        http::server::negotiate("br, gzip", options)
+    );
+    EXPECT_EQ(
+        content_coding::identity,
+        http::server::negotiate("br, zstd", options)
+    );
+}
+
+TEST(Compression, Response) {
+    auto memory = std::pmr::monotonic_buffer_resource();
+    auto request = http::server::request(&memory);
+    auto response = http::server::response();
+
+    request.headers.emplace("accept-encoding", "gzip");
+
+    const auto body = std::string(4096, 'a');
+    response.send(std::string(body));
+
+    http::server::compress(request, response, {});
+
+    EXPECT_EQ("gzip"sv, response.headers.find("content-encoding")->value);
+    EXPECT_EQ("accept-encoding"sv, response.headers.find("vary")->value);
+
+    const auto& data = std::get<std::string>(response.data);
+    ASSERT_LT(data.size(), body.size());
+    EXPECT_EQ('\x1f', data[0]);
+    EXPECT_EQ('\x8b', data[1]);
+
+    EXPECT_EQ(
+        std::to_string(data.size()),
+        response.headers.find("content-length")->value
+    );
+}
+
+TEST(Compression, ResponseBelowMinimum) {
+    auto memory = std::pmr::monotonic_buffer_resource();
+    auto request = http::server::request(&memory);
+    auto response = http::server::response();
+
+    request.headers.emplace("accept-encoding", "gzip");
+    response.send("small"sv);
+
+    http::server::compress(request, response, {});
+
+    EXPECT_FALSE(response.headers.contains("content-encoding"));
+    EXPECT_EQ("small"sv, std::get<std::string>(response.data));
+}
+
+TEST(Compression, ResponseAboveMaximum) {
+    auto memory = std::pmr::monotonic_buffer_resource();
+    auto request = http::server::request(&memory);
+    auto response = http::server::response();
+
+    request.headers.emplace("accept-encoding", "gzip");
+    response.send(std::string(4096, 'a'));
+
+    http::server::compress(request, response, {.max_size = 2048});
+
+    EXPECT_FALSE(response.headers.contains("content-encoding"));
+    EXPECT_EQ(4096, std::get<std::string>(response.data).size());
+}
+
+TEST(Compression, Precompressed) {
+    auto memory = std::pmr::monotonic_buffer_resource();
+    auto request = http::server::request(&memory);
+    auto response = http::server::response();
+
+    auto encodings = std::make_shared<http::server::file_encodings>();
+    auto& br = (*encodings)[std::size_t(content_coding::br)];
+    br.fd = std::make_shared<const netcore::fd>();
+    br.size = 100;
+
+    request.headers.emplace("accept-encoding", "gzip, br");
+    response.send(http::server::file {
+        .size = 4096,
+        .content_type = "text/plain",
+        .shared = std::make_shared<const netcore::fd>(),
+        .encodings = encodings});
+    response.headers.emplace("accept-ranges", "bytes");
+
+    http::server::compress(request, response, {});
+
+    EXPECT_EQ("br"sv, response.headers.find("content-encoding")->value);
+    EXPECT_EQ("100"sv, response.headers.find("content-length")->value);
+    EXPECT_FALSE(response.headers.contains("accept-ranges"));
+
+    const auto& file = std::get<http::server::file>(response.data);
+    EXPECT_EQ(br.fd, file.shared);
+    EXPECT_EQ(100, file.size);
+}
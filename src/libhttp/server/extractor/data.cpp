@@ -4,14 +4,29 @@ namespace http::server::extractor {
     auto data<std::string>::read(request& request) -> ext::task<std::string> {
         const auto length =
             request.header<std::optional<std::size_t>>("content-length");
+        const auto limit = request.max_body_size;
 
+        const auto check = [limit](std::size_t size) {
+            if (limit && size > *limit) {
+                throw error_code(413, "Request body exceeds {:L} bytes", *limit);
+            }
+        };
+
+        if (length) check(*length);
+
+        // The declared length is only a hint; never trust it further than
+        // the limit allows.
         auto string = std::string();
-        if (length) string.reserve(*length);
+        if (length) string.reserve(std::min(*length, limit.value_or(*length)));
 
         while (!request.eof) {
+            const auto start = std::chrono::steady_clock::now();
             co_await request.continuation;
+            request.waiting += std::chrono::steady_clock::now() - start;
 
             if (!request.data.empty()) {
+                check(string.size() + request.data.size());
+
                 string.append(
                     reinterpret_cast<const char*>(request.data.data()),
                     request.data.size()
@@ -24,7 +24,9 @@ namespace http::server::extractor {
 
     auto stream::read() -> ext::task<std::span<const std::byte>> {
         if (!request->eof && request->data.empty()) {
+            const auto start = std::chrono::steady_clock::now();
             co_await request->continuation;
+            request->waiting += std::chrono::steady_clock::now() - start;
         }
 
         co_return std::exchange(request->data, {});
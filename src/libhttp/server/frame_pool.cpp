@@ -0,0 +1,108 @@
+#include <http/server/frame_pool.hpp>
+
+#include <new>
+
+namespace {
+    // Frames may outlive the thread's pool: a detached coroutine can finish
+    // during thread teardown. These stay readable after the pool is gone so
+    // that such frames go back to the global allocator instead.
+    constinit thread_local http::server::frame_pool* current = nullptr;
+    constinit thread_local bool finished = false;
+
+    struct owner {
+        http::server::frame_pool pool;
+
+        owner() noexcept { current = &pool; }
+
+        ~owner() {
+            current = nullptr;
+            finished = true;
+        }
+    };
+
+    auto index(std::size_t size, std::size_t granularity) noexcept
+        -> std::size_t {
+        return (size + granularity - 1) / granularity - 1;
+    }
+}
+
+namespace http::server {
+    auto frame_pool::local() noexcept -> frame_pool* {
+        if (!current && !finished) {
+            thread_local auto instance = owner();
+        }
+
+        return current;
+    }
+
+    frame_pool::~frame_pool() {
+        for (auto* head : free) {
+            while (head) {
+                auto* const next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+
+    auto frame_pool::allocate(std::size_t size) -> void* {
+        if (size == 0 || size > max_size) {
+            ++stats.allocations;
+            return ::operator new(size);
+        }
+
+        const auto i = index(size, granularity);
+
+        if (auto* const head = free[i]) {
+            free[i] = head->next;
+            --counts[i];
+            --stats.cached;
+            ++stats.reuses;
+            return head;
+        }
+
+        // Round up so that any frame of the same class can reuse the block.
+        ++stats.allocations;
+        return ::operator new((i + 1) * granularity);
+    }
+
+    auto frame_pool::deallocate(void* ptr, std::size_t size) noexcept -> void {
+        if (size == 0 || size > max_size) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        const auto i = index(size, granularity);
+
+        // Keep the memory held by idle frames of each class bounded.
+        if (counts[i] >= budget / ((i + 1) * granularity)) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto* const head = static_cast<block*>(ptr);
+        head->next = free[i];
+        free[i] = head;
+
+        ++counts[i];
+        ++stats.cached;
+    }
+
+    auto frame_pool::statistics() const noexcept -> frame_statistics {
+        return stats;
+    }
+}
+
+namespace http::server::detail {
+    auto allocate_frame(std::size_t size) -> void* {
+        if (auto* const pool = frame_pool::local()) return pool->allocate(size);
+        return ::operator new(size);
+    }
+
+    auto deallocate_frame(void* ptr, std::size_t size) noexcept -> void {
+        if (auto* const pool = frame_pool::local()) {
+            pool->deallocate(ptr, size);
+        }
+        else ::operator delete(ptr);
+    }
+}
@@ -0,0 +1,108 @@
+#include <http/server/response/string.hpp>
+#include <http/server/router.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using http::server::frame_pool;
+
+namespace {
+    auto home() -> std::string { return "home"; }
+
+    auto run(http::server::router& router, http::server::stream& stream)
+        -> http::server::pooled_detached_task {
+        co_await router.route(stream);
+    }
+}
+
+TEST(FramePool, Reuse) {
+    auto pool = frame_pool();
+
+    auto* const first = pool.allocate(100);
+    pool.deallocate(first, 100);
+
+    auto* const second = pool.allocate(120);
+    EXPECT_EQ(first, second);
+    pool.deallocate(second, 120);
+
+    const auto stats = pool.statistics();
+    EXPECT_EQ(1, stats.allocations);
+    EXPECT_EQ(1, stats.reuses);
+    EXPECT_EQ(1, stats.cached);
+}
+
+TEST(FramePool, SteadyState) {
+    auto pool = frame_pool();
+    auto frames = std::vector<void*>();
+    const auto sizes = std::array<std::size_t, 4> {96, 320, 1024, 2500};
+
+    const auto run = [&] {
+        for (const auto size : sizes) frames.push_back(pool.allocate(size));
+        for (auto i = std::size_t(); i < sizes.size(); ++i) {
+            pool.deallocate(frames[i], sizes[i]);
+        }
+        frames.clear();
+    };
+
+    run();
+    const auto warm = pool.statistics().allocations;
+
+    for (auto i = 0; i < 100; ++i) run();
+
+    EXPECT_EQ(warm, pool.statistics().allocations);
+    EXPECT_EQ(400, pool.statistics().reuses);
+}
+
+TEST(FramePool, Oversized) {
+    auto pool = frame_pool();
+
+    auto* const frame = pool.allocate(frame_pool::max_size + 1);
+    pool.deallocate(frame, frame_pool::max_size + 1);
+
+    EXPECT_EQ(0, pool.statistics().cached);
+}
+
+TEST(FramePool, Route) {
+    using namespace http::server::routing;
+
+    auto router = http::server::router(table<route<"/", get<home>>>());
+    auto& pool = *frame_pool::local();
+
+    const auto request = [&] {
+        auto stream = http::server::stream();
+        stream.request.method = "GET";
+        stream.request.verb = http::server::method_type::get;
+        stream.request.path = "/";
+
+        run(router, stream);
+
+        EXPECT_EQ("home", std::get<std::string>(stream.response.data));
+    };
+
+    request();
+    const auto warm = pool.statistics();
+
+    for (auto i = 0; i < 10; ++i) request();
+
+    const auto stats = pool.statistics();
+    EXPECT_EQ(warm.allocations, stats.allocations);
+    EXPECT_EQ(warm.reuses + 20, stats.reuses);
+}
+
+TEST(FramePool, ThreadExit) {
+    // The holder is constructed before the pool and so destroyed after it.
+    std::thread([] {
+        struct holder {
+            void* frame = nullptr;
+
+            ~holder() {
+                http::server::detail::deallocate_frame(frame, 128);
+            }
+        };
+
+        thread_local auto held = holder();
+        held.frame = http::server::detail::allocate_frame(128);
+    }).join();
+}
@@ -0,0 +1,60 @@
+#include <http/server/handler.hpp>
+#include <http/server/response/string.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace http::server::extractor;
+
+namespace {
+    auto make_stream() -> std::unique_ptr<http::server::stream> {
+        auto stream = std::make_unique<http::server::stream>();
+
+        stream->request.method = "GET";
+        stream->request.params.emplace("id", "42");
+        stream->request.query.emplace("q", "search");
+
+        return stream;
+    }
+}
+
+TEST(Handler, Synchronous) {
+    auto stream = make_stream();
+    auto handler = http::server::make_handler(
+        [](path<"id", int> id, query<"q"> q, method method) -> std::string {
+            return fmt::format("{} {} {}", method.value, *id, **q);
+        }
+    );
+
+    EXPECT_TRUE(handler->try_handle(*stream));
+    EXPECT_EQ(
+        "GET 42 search",
+        std::get<std::string>(stream->response.data)
+    );
+}
+
+TEST(Handler, SynchronousVoid) {
+    auto stream = make_stream();
+    auto called = 0;
+    auto handler = http::server::make_handler([&](path<"id", int> id) {
+        called = *id;
+    });
+
+    EXPECT_TRUE(handler->try_handle(*stream));
+    EXPECT_EQ(42, called);
+}
+
+TEST(Handler, Asynchronous) {
+    auto stream = make_stream();
+    auto handler = http::server::make_handler([](std::string body) {
+        return body;
+    });
+
+    EXPECT_FALSE(handler->try_handle(*stream));
+}
+
+TEST(Handler, ExtractorError) {
+    auto stream = make_stream();
+    auto handler = http::server::make_handler([](path<"missing"> value) {});
+
+    EXPECT_THROW(handler->try_handle(*stream), http::error_code);
+}
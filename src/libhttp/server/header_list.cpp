@@ -0,0 +1,224 @@
+#include <http/server/header_list.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <utility>
+
+using namespace std::literals;
+
+namespace {
+    // Sorted so that lookups can use a binary search.
+    constexpr auto static_names = std::array {
+        "accept-ranges"sv,
+        "access-control-allow-headers"sv,
+        "access-control-allow-methods"sv,
+        "access-control-allow-origin"sv,
+        "age"sv,
+        "allow"sv,
+        "cache-control"sv,
+        "content-disposition"sv,
+        "content-encoding"sv,
+        "content-language"sv,
+        "content-length"sv,
+        "content-location"sv,
+        "content-range"sv,
+        "content-type"sv,
+        "date"sv,
+        "etag"sv,
+        "expires"sv,
+        "last-modified"sv,
+        "link"sv,
+        "location"sv,
+        "retry-after"sv,
+        "server"sv,
+        "set-cookie"sv,
+        "strict-transport-security"sv,
+        "vary"sv,
+        "www-authenticate"sv,
+    };
+
+    static_assert(std::ranges::is_sorted(static_names));
+
+    constexpr auto status_codes = [] {
+        auto table = std::array<std::array<char, 3>, 500>();
+
+        for (auto i = 0; i < 500; ++i) {
+            const auto status = i + 100;
+
+            table[i] = {
+                static_cast<char>('0' + status / 100),
+                static_cast<char>('0' + status / 10 % 10),
+                static_cast<char>('0' + status % 10)};
+        }
+
+        return table;
+    }();
+
+    auto lower(char c) noexcept -> char {
+        return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+    }
+
+    auto iequals(std::string_view a, std::string_view b) noexcept -> bool {
+        return std::ranges::equal(a, b, [](char x, char y) {
+            return lower(x) == lower(y);
+        });
+    }
+
+    auto is_lower(std::string_view string) noexcept -> bool {
+        return std::ranges::none_of(string, [](char c) {
+            return c >= 'A' && c <= 'Z';
+        });
+    }
+}
+
+namespace http::server {
+    auto status_string(int status) noexcept -> std::string_view {
+        if (status < 100 || status > 599) status = 500;
+
+        const auto& code = status_codes[status - 100];
+        return {code.data(), code.size()};
+    }
+
+    header_list::header_list() :
+        arena(buffer.data(), buffer.size()),
+        fields(&arena) {
+        fields.reserve(inline_fields);
+    }
+
+    header_list::header_list(const header_list& other) : header_list() {
+        for (const auto& field : other) emplace(field.name, field.value);
+    }
+
+    header_list::header_list(header_list&& other) :
+        header_list(std::as_const(other)) {}
+
+    auto header_list::operator=(const header_list& other) -> header_list& {
+        if (std::addressof(other) != this) {
+            clear();
+            for (const auto& field : other) emplace(field.name, field.value);
+        }
+
+        return *this;
+    }
+
+    auto header_list::operator=(header_list&& other) -> header_list& {
+        return *this = std::as_const(other);
+    }
+
+    auto header_list::begin() const noexcept -> const_iterator {
+        return fields.begin();
+    }
+
+    auto header_list::clear() -> void {
+        std::destroy_at(&fields);
+        arena.release();
+        std::construct_at(&fields, &arena);
+
+        fields.reserve(inline_fields);
+    }
+
+    auto header_list::contains(std::string_view name) const noexcept -> bool {
+        return find(name) != nullptr;
+    }
+
+    auto header_list::copy(std::string_view string) -> std::string_view {
+        if (string.empty()) return {};
+
+        auto* const data =
+            static_cast<char*>(arena.allocate(string.size(), alignof(char)));
+
+        string.copy(data, string.size());
+
+        return {data, string.size()};
+    }
+
+    auto header_list::emplace(std::string_view name, std::string_view value)
+        -> bool {
+        if (contains(name)) return false;
+
+        auto field = intern(name);
+        field.value = copy(value);
+
+        fields.push_back(field);
+        return true;
+    }
+
+    auto header_list::emplace(std::string_view name, std::size_t value)
+        -> bool {
+        auto buffer = std::array<char, 20>();
+        const auto [ptr, ec] =
+            std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+
+        return emplace(name, std::string_view(buffer.data(), ptr));
+    }
+
+    auto header_list::empty() const noexcept -> bool { return fields.empty(); }
+
+    auto header_list::end() const noexcept -> const_iterator {
+        return fields.end();
+    }
+
+    auto header_list::erase(std::string_view name) noexcept -> bool {
+        const auto it = std::ranges::find_if(fields, [name](const auto& field) {
+            return iequals(field.name, name);
+        });
+
+        if (it == fields.end()) return false;
+
+        fields.erase(it);
+        return true;
+    }
+
+    auto header_list::find(std::string_view name) const noexcept
+        -> const field* {
+        for (const auto& field : fields) {
+            if (iequals(field.name, name)) return &field;
+        }
+
+        return nullptr;
+    }
+
+    auto header_list::intern(std::string_view name) -> field {
+        const auto it = std::ranges::lower_bound(
+            static_names,
+            name,
+            [](std::string_view a, std::string_view b) {
+                return std::ranges::lexicographical_compare(
+                    a,
+                    b,
+                    [](char x, char y) { return lower(x) < lower(y); }
+                );
+            }
+        );
+
+        if (it != static_names.end() && iequals(*it, name)) {
+            return {.name = *it, .static_name = true};
+        }
+
+        if (is_lower(name)) return {.name = copy(name)};
+
+        auto* const data =
+            static_cast<char*>(arena.allocate(name.size(), alignof(char)));
+
+        std::ranges::transform(name, data, lower);
+
+        return {.name = {data, name.size()}};
+    }
+
+    auto header_list::set(std::string_view name, std::string_view value)
+        -> void {
+        for (auto& field : fields) {
+            if (iequals(field.name, name)) {
+                field.value = copy(value);
+                return;
+            }
+        }
+
+        emplace(name, value);
+    }
+
+    auto header_list::size() const noexcept -> std::size_t {
+        return fields.size();
+    }
+}
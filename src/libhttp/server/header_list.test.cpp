@@ -0,0 +1,62 @@
+#include <http/server/header_list.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace std::literals;
+
+TEST(HeaderList, StaticNames) {
+    auto headers = http::server::header_list();
+
+    EXPECT_TRUE(headers.emplace("Content-Type", "text/plain"));
+    EXPECT_TRUE(headers.emplace("X-Custom", "value"));
+    EXPECT_FALSE(headers.emplace("content-type", "application/json"));
+
+    const auto* type = headers.find("content-type");
+    ASSERT_NE(nullptr, type);
+    EXPECT_EQ("content-type"sv, type->name);
+    EXPECT_EQ("text/plain"sv, type->value);
+    EXPECT_TRUE(type->static_name);
+
+    const auto* custom = headers.find("x-custom");
+    ASSERT_NE(nullptr, custom);
+    EXPECT_EQ("x-custom"sv, custom->name);
+    EXPECT_FALSE(custom->static_name);
+}
+
+TEST(HeaderList, Length) {
+    auto headers = http::server::header_list();
+
+    headers.emplace("content-length", std::size_t(1234567));
+
+    EXPECT_EQ("1234567"sv, headers.find("content-length")->value);
+}
+
+TEST(HeaderList, SetAndErase) {
+    auto headers = http::server::header_list();
+
+    headers.set("vary", "accept");
+    headers.set("vary", "accept-encoding");
+
+    EXPECT_EQ(1, headers.size());
+    EXPECT_EQ("accept-encoding"sv, headers.find("vary")->value);
+
+    EXPECT_TRUE(headers.erase("vary"));
+    EXPECT_TRUE(headers.empty());
+}
+
+TEST(HeaderList, Copy) {
+    auto headers = http::server::header_list();
+    headers.emplace("etag", "\"abc\"");
+
+    const auto copy = headers;
+    headers.clear();
+
+    EXPECT_TRUE(headers.empty());
+    EXPECT_EQ("\"abc\""sv, copy.find("etag")->value);
+}
+
+TEST(HeaderList, StatusString) {
+    EXPECT_EQ("200"sv, http::server::status_string(200));
+    EXPECT_EQ("404"sv, http::server::status_string(404));
+    EXPECT_EQ("500"sv, http::server::status_string(42));
+}
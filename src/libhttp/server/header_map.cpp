@@ -0,0 +1,47 @@
+#include <http/server/header_map.hpp>
+
+namespace http::server {
+    header_map::header_map(std::pmr::memory_resource* resource) :
+        entries(resource),
+        hashes(resource) {
+        entries.reserve(initial_capacity);
+        hashes.reserve(initial_capacity);
+    }
+
+    auto header_map::begin() const noexcept -> const_iterator {
+        return entries.begin();
+    }
+
+    auto header_map::contains(std::string_view name) const noexcept -> bool {
+        return find(name) != end();
+    }
+
+    auto header_map::emplace(std::string_view name, std::string_view value)
+        -> void {
+        entries.emplace_back(name, value);
+        hashes.push_back(hash(name));
+    }
+
+    auto header_map::empty() const noexcept -> bool { return entries.empty(); }
+
+    auto header_map::end() const noexcept -> const_iterator {
+        return entries.end();
+    }
+
+    auto header_map::find(std::string_view name) const noexcept
+        -> const_iterator {
+        const auto key = hash(name);
+
+        for (std::size_t i = 0; i < hashes.size(); ++i) {
+            if (hashes[i] == key && entries[i].first == name) {
+                return entries.begin() + i;
+            }
+        }
+
+        return entries.end();
+    }
+
+    auto header_map::size() const noexcept -> std::size_t {
+        return entries.size();
+    }
+}
@@ -0,0 +1,362 @@
+#include <http/error.h>
+#include <http/server/http1/parser.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ext/string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr auto max_chunk_line = std::size_t(1024);
+
+    auto is_token(char c) noexcept -> bool {
+        if (c >= 'a' && c <= 'z') return true;
+        if (c >= 'A' && c <= 'Z') return true;
+        if (c >= '0' && c <= '9') return true;
+
+        switch (c) {
+            case '!':
+            case '#':
+            case '$':
+            case '%':
+            case '&':
+            case '\'':
+            case '*':
+            case '+':
+            case '-':
+            case '.':
+            case '^':
+            case '_':
+            case '`':
+            case '|':
+            case '~': return true;
+            default: return false;
+        }
+    }
+
+    auto is_ctl(char c) noexcept -> bool {
+        return static_cast<unsigned char>(c) < 0x20 || c == 0x7f;
+    }
+
+    auto iequals(std::string_view a, std::string_view b) noexcept -> bool {
+        return std::ranges::equal(a, b, [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) ==
+                   std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    auto has_token(std::string_view list, std::string_view token) -> bool {
+        for (const auto item : ext::string_range(list, ",")) {
+            if (iequals(ext::trim(item), token)) return true;
+        }
+
+        return false;
+    }
+
+    auto trim(std::string_view string) noexcept -> std::string_view {
+        while (!string.empty() &&
+               (string.front() == ' ' || string.front() == '\t'))
+            string.remove_prefix(1);
+
+        while (!string.empty() &&
+               (string.back() == ' ' || string.back() == '\t'))
+            string.remove_suffix(1);
+
+        return string;
+    }
+}
+
+namespace http::server::http1 {
+    auto detail::apply(
+        head_info& info,
+        std::string_view name,
+        std::string_view value
+    ) -> void {
+        if (name == "content-length") {
+            auto length = std::size_t();
+            const auto* const end = value.data() + value.size();
+            const auto [ptr, ec] = std::from_chars(value.data(), end, length);
+
+            if (ec != std::errc() || ptr != end || value.empty()) {
+                throw error_code(400, "Invalid content length");
+            }
+
+            if (info.content_length && *info.content_length != length) {
+                throw error_code(400, "Conflicting content lengths");
+            }
+
+            info.content_length = length;
+        }
+        else if (name == "transfer-encoding") {
+            // Only chunked is decoded, and it must be the final coding
+            // (RFC 9112 §6.3); anything else leaves the body length
+            // ambiguous, which is how requests get smuggled.
+            auto codings = std::size_t();
+
+            for (const auto item : ext::string_range(value, ",")) {
+                const auto coding = ext::trim(item);
+                if (coding.empty()) continue;
+
+                if (info.chunked) {
+                    throw error_code(400, "Chunked must be the final coding");
+                }
+
+                if (!iequals(coding, "chunked")) {
+                    throw error_code(501, "Unsupported transfer encoding");
+                }
+
+                info.chunked = true;
+                ++codings;
+            }
+
+            if (codings == 0) throw error_code(400, "Empty transfer encoding");
+        }
+        else if (name == "connection") {
+            if (has_token(value, "close")) info.keep_alive = false;
+            else if (has_token(value, "keep-alive")) info.keep_alive = true;
+        }
+        else if (name == "expect") {
+            info.expect_continue = iequals(value, "100-continue");
+        }
+    }
+
+    auto detail::find(std::string_view data, char c) noexcept -> std::size_t {
+        const auto* const begin = data.data();
+        const auto* const end = begin + data.size();
+        const auto* it = begin;
+
+#ifdef __SSE2__
+        const auto needle = _mm_set1_epi8(c);
+
+        while (end - it >= 16) {
+            const auto block =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const auto mask =
+                _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+
+            if (mask != 0) return (it - begin) + __builtin_ctz(mask);
+
+            it += 16;
+        }
+#endif
+
+        while (it != end) {
+            if (*it == c) return it - begin;
+            ++it;
+        }
+
+        return std::string_view::npos;
+    }
+
+    auto detail::line_end(std::string_view data) -> std::size_t {
+        const auto lf = find(data, '\n');
+
+        if (lf == std::string_view::npos) {
+            throw error_code(400, "Incomplete line");
+        }
+
+        // A bare LF is read as a line break by some parsers and not by
+        // others, which is enough to smuggle a request past a proxy.
+        if (lf == 0 || data[lf - 1] != '\r') {
+            throw error_code(400, "Line not terminated by CRLF");
+        }
+
+        return lf - 1;
+    }
+
+    auto detail::parse_header(std::span<char> line)
+        -> std::pair<std::string_view, std::string_view> {
+        const auto data = std::string_view(line.data(), line.size());
+        const auto colon = find(data, ':');
+
+        if (colon == 0 || colon == std::string_view::npos) {
+            throw error_code(400, "Malformed header field");
+        }
+
+        for (std::size_t i = 0; i < colon; ++i) {
+            auto& c = line[i];
+
+            if (!is_token(c)) {
+                throw error_code(400, "Invalid header field name");
+            }
+
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+        const auto value = trim(data.substr(colon + 1));
+
+        for (const auto c : value) {
+            if (is_ctl(c) && c != '\t') {
+                throw error_code(400, "Invalid header field value");
+            }
+        }
+
+        return {data.substr(0, colon), value};
+    }
+
+    auto detail::parse_request_line(std::string_view line) -> request_line {
+        const auto first = find(line, ' ');
+        if (first == 0 || first == std::string_view::npos) {
+            throw error_code(400, "Malformed request line");
+        }
+
+        const auto rest = line.substr(first + 1);
+        const auto second = find(rest, ' ');
+        if (second == 0 || second == std::string_view::npos) {
+            throw error_code(400, "Malformed request line");
+        }
+
+        const auto version = rest.substr(second + 1);
+        if (version.size() != 8 || !version.starts_with("HTTP/1.") ||
+            (version[7] != '0' && version[7] != '1')) {
+            throw error_code(505, "HTTP version not supported");
+        }
+
+        const auto method = line.substr(0, first);
+        auto target = rest.substr(0, second);
+        auto authority = std::string_view();
+
+        for (const auto c : target) {
+            if (is_ctl(c)) throw error_code(400, "Invalid request target");
+        }
+
+        // Besides the origin form, only the absolute form (RFC 9112 §3.2.2)
+        // and the asterisk form for OPTIONS are accepted.
+        const auto asterisk = target == "*" && method == "OPTIONS";
+
+        if (!target.starts_with('/') && !asterisk) {
+            const auto separator = target.find("://");
+            const auto scheme = target.substr(0, separator);
+
+            if (separator == std::string_view::npos ||
+                !(iequals(scheme, "http") || iequals(scheme, "https"))) {
+                throw error_code(400, "Invalid request target");
+            }
+
+            target.remove_prefix(separator + 3);
+
+            const auto end =
+                std::min(target.find_first_of("/?"), target.size());
+            authority = target.substr(0, end);
+            target = end == target.size() ? "/" : target.substr(end);
+
+            if (authority.empty()) {
+                throw error_code(400, "Invalid request target");
+            }
+        }
+
+        return {
+            .method = method,
+            .target = target,
+            .authority = authority,
+            .minor_version = version[7] - '0'};
+    }
+
+    auto head_size(std::string_view data) noexcept -> std::size_t {
+        std::size_t pos = 0;
+
+        while (true) {
+            const auto lf = detail::find(data.substr(pos), '\n');
+            if (lf == std::string_view::npos) return 0;
+
+            const auto end = pos + lf;
+            pos = end + 1;
+
+            // The head ends early at a bare LF so that parsing rejects it
+            // rather than waiting for a terminator that may never come.
+            if (end == 0 || data[end - 1] != '\r') return pos;
+
+            if (data.substr(pos).starts_with("\r\n")) return pos + 2;
+        }
+    }
+
+    auto chunked_decoder::decode(std::string_view& input)
+        -> std::optional<std::string_view> {
+        while (!input.empty()) {
+            switch (current) {
+                case state::size: {
+                    const auto lf = detail::find(input, '\n');
+
+                    if (lf == std::string_view::npos) {
+                        if (input.size() > max_chunk_line) {
+                            throw error_code(400, "Malformed chunk size");
+                        }
+
+                        return std::nullopt;
+                    }
+
+                    auto line = input.substr(0, lf);
+
+                    if (!line.ends_with('\r')) {
+                        throw error_code(400, "Malformed chunk size");
+                    }
+
+                    line.remove_suffix(1);
+                    line = trim(line.substr(0, detail::find(line, ';')));
+
+                    const auto* const end = line.data() + line.size();
+                    const auto [ptr, ec] =
+                        std::from_chars(line.data(), end, remaining, 16);
+
+                    if (ec != std::errc() || ptr != end || line.empty()) {
+                        throw error_code(400, "Malformed chunk size");
+                    }
+
+                    input.remove_prefix(lf + 1);
+                    current = remaining == 0 ? state::trailer : state::data;
+                    break;
+                }
+                case state::data: {
+                    const auto size = std::min(remaining, input.size());
+                    const auto data = input.substr(0, size);
+
+                    input.remove_prefix(size);
+                    remaining -= size;
+
+                    if (remaining == 0) current = state::data_end;
+
+                    return data;
+                }
+                case state::data_end: {
+                    const auto lf = detail::find(input, '\n');
+                    if (lf == std::string_view::npos) return std::nullopt;
+
+                    const auto line = input.substr(0, lf);
+                    if (line != "\r") {
+                        throw error_code(400, "Malformed chunk");
+                    }
+
+                    input.remove_prefix(lf + 1);
+                    current = state::size;
+                    break;
+                }
+                case state::trailer: {
+                    const auto lf = detail::find(input, '\n');
+                    if (lf == std::string_view::npos) return std::nullopt;
+
+                    const auto line = input.substr(0, lf);
+
+                    if (!line.ends_with('\r')) {
+                        throw error_code(400, "Malformed chunk trailer");
+                    }
+
+                    input.remove_prefix(lf + 1);
+
+                    if (line == "\r") current = state::done;
+                    break;
+                }
+                case state::done: return std::nullopt;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    auto chunked_decoder::done() const noexcept -> bool {
+        return current == state::done;
+    }
+}
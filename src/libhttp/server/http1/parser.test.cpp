@@ -0,0 +1,236 @@
+#include <http/error.h>
+#include <http/server/http1/parser.hpp>
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+
+using namespace std::literals;
+
+namespace http1 = http::server::http1;
+
+TEST(Http1Parser, HeadSize) {
+    EXPECT_EQ(0, http1::head_size("GET / HTTP/1.1\r\nhost: a\r\n"));
+    EXPECT_EQ(27, http1::head_size("GET / HTTP/1.1\r\nhost: a\r\n\r\nbody"));
+    EXPECT_EQ(15, http1::head_size("GET / HTTP/1.0\n\n"));
+    EXPECT_EQ(24, http1::head_size("GET / HTTP/1.1\r\nhost: a\n\r\n"));
+}
+
+TEST(Http1Parser, Head) {
+    auto head = std::string(
+        "POST /users?id=1 HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "Content-Length: 13\r\n"
+        "X-Long-Header-Name-Over-Sixteen:   value  \r\n"
+        "\r\n"
+    );
+
+    auto line = http1::request_line();
+    auto headers = std::map<std::string, std::string>();
+
+    const auto info = http1::parse_head(
+        std::span(head.data(), head.size()),
+        line,
+        [&](std::string_view name, std::string_view value) {
+            headers.emplace(name, value);
+        }
+    );
+
+    EXPECT_EQ("POST"sv, line.method);
+    EXPECT_EQ("/users?id=1"sv, line.target);
+    EXPECT_EQ(1, line.minor_version);
+
+    EXPECT_EQ(13, info.content_length);
+    EXPECT_FALSE(info.chunked);
+    EXPECT_TRUE(info.keep_alive);
+
+    EXPECT_EQ("example.com", headers.at("host"));
+    EXPECT_EQ("value", headers.at("x-long-header-name-over-sixteen"));
+}
+
+TEST(Http1Parser, KeepAlive) {
+    auto head = std::string("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+    auto line = http1::request_line();
+
+    const auto info = http1::parse_head(
+        std::span(head.data(), head.size()),
+        line,
+        [](auto, auto) {}
+    );
+
+    EXPECT_EQ(0, line.minor_version);
+    EXPECT_TRUE(info.keep_alive);
+}
+
+TEST(Http1Parser, MalformedHead) {
+    auto head = std::string("GET / HTTP/2.0\r\n\r\n");
+    auto line = http1::request_line();
+
+    EXPECT_THROW(
+        http1::parse_head(
+            std::span(head.data(), head.size()),
+            line,
+            [](auto, auto) {}
+        ),
+        http::error_code
+    );
+}
+
+TEST(Http1Parser, Chunked) {
+    auto decoder = http1::chunked_decoder();
+    auto body = std::string();
+
+    auto input = "5\r\nHello\r\n8;ext=1\r\n, world!\r\n0\r\n\r\nGET"sv;
+
+    while (const auto data = decoder.decode(input)) body.append(*data);
+
+    EXPECT_TRUE(decoder.done());
+    EXPECT_EQ("Hello, world!", body);
+    EXPECT_EQ("GET"sv, input);
+}
+
+TEST(Http1Parser, TransferEncoding) {
+    const auto status = [](std::string_view value) {
+        auto info = http1::head_info();
+
+        try {
+            http1::detail::apply(info, "transfer-encoding", value);
+        }
+        catch (const http::error_code& error) {
+            return error.code();
+        }
+
+        return info.chunked ? 200 : 0;
+    };
+
+    EXPECT_EQ(200, status("chunked"));
+    EXPECT_EQ(200, status("Chunked "));
+    EXPECT_EQ(501, status("gzip"));
+    EXPECT_EQ(501, status("gzip, chunked"));
+    EXPECT_EQ(501, status("chunk\xc3\xa9" "d"));
+    EXPECT_EQ(400, status("chunked, gzip"));
+    EXPECT_EQ(400, status("chunked, chunked"));
+    EXPECT_EQ(400, status(""));
+    EXPECT_EQ(400, status(" , "));
+}
+
+TEST(Http1Parser, TransferEncodingLines) {
+    auto head = std::string(
+        "POST / HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "Transfer-Encoding: gzip\r\n"
+        "\r\n"
+    );
+    auto line = http1::request_line();
+
+    try {
+        http1::parse_head(
+            std::span(head.data(), head.size()),
+            line,
+            [](auto, auto) {}
+        );
+        FAIL() << "Expected an error";
+    }
+    catch (const http::error_code& error) {
+        EXPECT_EQ(400, error.code());
+    }
+}
+
+TEST(Http1Parser, InvalidHeaderName) {
+    auto head = std::string("GET / HTTP/1.1\r\nX-\xc3\x89T\xc3\x89: 1\r\n\r\n");
+    auto line = http1::request_line();
+
+    EXPECT_THROW(
+        http1::parse_head(
+            std::span(head.data(), head.size()),
+            line,
+            [](auto, auto) {}
+        ),
+        http::error_code
+    );
+}
+
+TEST(Http1Parser, BareLineFeed) {
+    for (const auto* const text :
+         {"GET / HTTP/1.1\n\n",
+          "GET / HTTP/1.1\r\nHost: a\n\r\n",
+          "GET / HTTP/1.1\r\nHost: a\r\n\n"}) {
+        auto head = std::string(text);
+        head.resize(http1::head_size(head));
+        auto line = http1::request_line();
+
+        EXPECT_THROW(
+            http1::parse_head(
+                std::span(head.data(), head.size()),
+                line,
+                [](auto, auto) {}
+            ),
+            http::error_code
+        ) << text;
+    }
+
+    auto decoder = http1::chunked_decoder();
+    auto input = "5\nHello\r\n0\r\n\r\n"sv;
+
+    EXPECT_THROW(decoder.decode(input), http::error_code);
+}
+
+TEST(Http1Parser, ControlCharacters) {
+    for (const auto value : {"a\rb"sv, "a\0b"sv, "a\x7f"sv}) {
+        auto head = std::string("GET / HTTP/1.1\r\nX-Test: ");
+        head.append(value);
+        head.append("\r\n\r\n");
+        auto line = http1::request_line();
+
+        EXPECT_THROW(
+            http1::parse_head(
+                std::span(head.data(), head.size()),
+                line,
+                [](auto, auto) {}
+            ),
+            http::error_code
+        );
+    }
+
+    auto head = std::string("GET / HTTP/1.1\r\nX-Test: a\tb\r\n\r\n");
+    auto line = http1::request_line();
+    auto value = std::string();
+
+    http1::parse_head(
+        std::span(head.data(), head.size()),
+        line,
+        [&](auto, auto v) { value = v; }
+    );
+
+    EXPECT_EQ("a\tb", value);
+}
+
+TEST(Http1Parser, RequestTarget) {
+    const auto line = http1::detail::parse_request_line(
+        "GET http://example.com:8080/a?b=1 HTTP/1.1"
+    );
+
+    EXPECT_EQ("example.com:8080"sv, line.authority);
+    EXPECT_EQ("/a?b=1"sv, line.target);
+
+    EXPECT_EQ(
+        "/"sv,
+        http1::detail::parse_request_line("GET HTTPS://a HTTP/1.1").target
+    );
+    EXPECT_EQ(
+        "*"sv,
+        http1::detail::parse_request_line("OPTIONS * HTTP/1.1").target
+    );
+
+    for (const auto* const text :
+         {"GET * HTTP/1.1",
+          "GET example.com HTTP/1.1",
+          "GET ftp://a/ HTTP/1.1",
+          "GET http:///a HTTP/1.1",
+          "GET /a\x01 HTTP/1.1"}) {
+        EXPECT_THROW(
+            http1::detail::parse_request_line(text),
+            http::error_code
+        ) << text;
+    }
+}
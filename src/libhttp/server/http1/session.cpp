@@ -0,0 +1,816 @@
+#include <http/server/http1/session.hpp>
+#include <http/server/response/string.hpp>
+
+#include <charconv>
+#include <netcore/netcore>
+
+using namespace std::literals;
+
+namespace {
+    constexpr auto continue_response = "HTTP/1.1 100 Continue\r\n\r\n"sv;
+    constexpr auto crlf = "\r\n"sv;
+    constexpr auto last_chunk = "0\r\n\r\n"sv;
+    constexpr auto file_buffer_size = std::size_t(64 * 1024);
+
+    auto as_bytes(std::string_view string) -> std::span<const std::byte> {
+        return std::as_bytes(std::span(string.data(), string.size()));
+    }
+
+    auto as_string(std::span<const std::byte> bytes) -> std::string_view {
+        return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+
+    auto has_body(int status) noexcept -> bool {
+        return status >= 200 && status != 204 && status != 304;
+    }
+
+    auto reason(int status) noexcept -> std::string_view {
+        switch (status) {
+            case 100: return "Continue";
+            case 101: return "Switching Protocols";
+            case 200: return "OK";
+            case 201: return "Created";
+            case 202: return "Accepted";
+            case 204: return "No Content";
+            case 206: return "Partial Content";
+            case 301: return "Moved Permanently";
+            case 302: return "Found";
+            case 303: return "See Other";
+            case 304: return "Not Modified";
+            case 307: return "Temporary Redirect";
+            case 308: return "Permanent Redirect";
+            case 400: return "Bad Request";
+            case 401: return "Unauthorized";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 406: return "Not Acceptable";
+            case 408: return "Request Timeout";
+            case 409: return "Conflict";
+            case 410: return "Gone";
+            case 411: return "Length Required";
+            case 412: return "Precondition Failed";
+            case 413: return "Content Too Large";
+            case 414: return "URI Too Long";
+            case 415: return "Unsupported Media Type";
+            case 416: return "Range Not Satisfiable";
+            case 417: return "Expectation Failed";
+            case 422: return "Unprocessable Content";
+            case 429: return "Too Many Requests";
+            case 431: return "Request Header Fields Too Large";
+            case 500: return "Internal Server Error";
+            case 501: return "Not Implemented";
+            case 502: return "Bad Gateway";
+            case 503: return "Service Unavailable";
+            case 504: return "Gateway Timeout";
+            case 505: return "HTTP Version Not Supported";
+            default: return "Unknown";
+        }
+    }
+}
+
+namespace http::server::http1 {
+    session::session(
+        server::socket&& socket,
+        const server::options& options,
+        server::router& router,
+        server::counters& counters,
+        concurrency_limit* admission
+    ) :
+        stream(1, &memory),
+        requests(1),
+        socket(std::forward<server::socket>(socket)),
+        options(options.http1),
+        limits(options.limits),
+        timeouts(options.timeouts),
+        router(&router),
+        counters(&counters),
+        admission(admission),
+        deadline([this] {
+            TIMBER_DEBUG("{} timed out", *this);
+            closed.resume();
+        }) {
+        stream.handler_timeout.set_callback([this] { time_out(); });
+        TIMBER_TRACE("{} created for {}", *this, this->socket);
+    }
+
+    session::~session() {
+        unlink();
+
+        if (router) { TIMBER_TRACE("{} destroyed", *this); }
+    }
+
+    auto session::abandoned() const noexcept -> bool { return stream.active; }
+
+    auto session::await_close() -> ext::task<> {
+        auto exception = std::exception_ptr();
+
+        try {
+            co_await closed;
+            TIMBER_TRACE("{} close requested", *this);
+            co_return;
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+
+        co_await netcore::yield();
+        std::rethrow_exception(exception);
+    }
+
+    auto session::await_handlers() -> ext::task<> { co_await tasks.await(); }
+
+    auto session::close() noexcept -> void {
+        auto* current = this;
+
+        do {
+            // `current` may unlink itself from the list.
+            auto* const next = current->next;
+
+            current->closed.resume();
+
+            current = next;
+        } while (current != this);
+    }
+
+    auto session::deliver(std::span<const std::byte> data) -> ext::task<> {
+        auto& request = stream.request;
+
+        if (finished || request.discard) {
+            TIMBER_DEBUG(
+                "Stream ID {} discarded data chunk of {:L} bytes",
+                stream.id,
+                data.size()
+            );
+
+            co_return;
+        }
+
+        TIMBER_TRACE(
+            "Stream ID {} received data chunk of {:L} bytes",
+            stream.id,
+            data.size()
+        );
+
+        stream.received += data.size();
+
+        const auto limit = request.max_body_size;
+
+        if (limit && stream.received > *limit) {
+            throw error_code(413, "Request body exceeds {:L} bytes", *limit);
+        }
+
+        request.data = data;
+
+        if (request.continuation) {
+            request.continuation.resume();
+            if (finished || request.discard || request.continuation) co_return;
+        }
+
+        // The handler has not consumed this chunk yet: stop reading until it
+        // asks for more, discards the body, or finishes.
+        co_await request.continuation;
+    }
+
+    auto session::drain() noexcept -> void {
+        auto* current = this;
+
+        do {
+            auto* const next = current->next;
+
+            // Connections waiting for their next request can go now; the
+            // rest close once their current response is written.
+            current->draining = true;
+            if (current->idle) current->closed.resume();
+
+            current = next;
+        } while (current != this);
+    }
+
+    auto session::fail(const error_code& error) -> ext::task<> {
+        deadline.cancel();
+
+        TIMBER_DEBUG(
+            "{} rejected request: {} ({})",
+            *this,
+            error.code(),
+            error.what()
+        );
+
+        stream.response.clear();
+        stream.response.status = error.code();
+        stream.response.send(error.what());
+
+        co_await respond(request_line(), false);
+    }
+
+    auto session::handle_connection() -> ext::task<> {
+        try {
+            co_await recv();
+            socket.shutdown();
+        }
+        catch (const netcore::eof&) {
+            TIMBER_DEBUG("{} received unexpected EOF", *this);
+        }
+        catch (const std::system_error& ex) {
+            using timber::level;
+
+            const auto code = std::errc(ex.code().value());
+            const auto lvl = stream.active ? level::error : level::debug;
+
+            switch (code) {
+                case std::errc::connection_reset:
+                    TIMBER_LOG(lvl, ex.what());
+                    break;
+                default: TIMBER_ERROR(ex.what());
+            }
+        }
+        catch (const std::exception& ex) {
+            TIMBER_ERROR(ex.what());
+        }
+
+        if (!stream.active) {
+            co_await tasks.await();
+            co_return;
+        }
+
+        // The handler outlived the connection, most likely by ignoring its
+        // timeout: release the connection now and leave the session to the
+        // caller, which must keep it until the handler returns.
+        TIMBER_DEBUG("{} abandoning stream ID {}", *this, stream.id);
+
+        unlink();
+        stream.abort();
+        socket = server::socket();
+    }
+
+    auto session::handle_request(concurrency_limit::permit permit)
+        -> pooled_detached_task {
+        const auto counter = tasks.increment();
+        stream.active = true;
+        counters->request();
+
+        TIMBER_DEBUG("{}", stream);
+
+        stream.handler_timeout.arm(timeouts.handler);
+        stream.request.max_body_size = limits.max_body_size;
+
+        try {
+            if (!co_await router->route(stream)) stream.open = false;
+        }
+        catch (const std::exception& ex) {
+            TIMBER_ERROR("Session handler failed: {}", ex.what());
+            stream.open = false;
+        }
+        catch (...) {
+            TIMBER_ERROR("Session handler failed");
+            stream.open = false;
+        }
+
+        stream.handler_timeout.cancel();
+        permit.release(stream.request.waiting);
+
+        stream.active = false;
+        finished = true;
+
+        // Hand control back to the connection, which is either waiting for
+        // the body to be consumed or for the response to be ready.
+        auto& request = stream.request;
+
+        if (request.continuation.awaiting()) {
+            request.discard = true;
+            request.continuation.resume();
+        }
+        else if (done.awaiting()) done.resume();
+    }
+
+    auto session::link(session& other) noexcept -> void {
+        other.next = this;
+        other.prev = prev;
+
+        prev->next = &other;
+        prev = &other;
+    }
+
+    auto session::read() -> ext::task<bool> {
+        auto result = co_await ext::race(socket.read(), await_close());
+
+        if (result.index() == 1) {
+            TIMBER_TRACE("{} closing", *this);
+            co_await std::get<1>(std::move(result));
+            co_return false;
+        }
+
+        pending = co_await std::get<0>(std::move(result));
+        co_return !pending.empty();
+    }
+
+    auto session::read_body(const head_info& info) -> ext::task<bool> {
+        auto complete = false;
+        auto failure = std::exception_ptr();
+
+        try {
+            if (info.chunked) complete = co_await recv_chunked();
+            else complete = co_await recv_length(*info.content_length);
+        }
+        catch (const error_code& error) {
+            TIMBER_DEBUG(
+                "Stream ID {} failed to read request body: {}",
+                stream.id,
+                error.what()
+            );
+
+            failure = std::current_exception();
+        }
+        catch (const stream_aborted&) {
+            TIMBER_DEBUG("Stream ID {} aborted", stream.id);
+        }
+
+        auto& request = stream.request;
+
+        request.data = std::span<const std::byte>();
+        request.eof = true;
+
+        // A handler waiting for more data learns why there is none.
+        if (failure && request.continuation) {
+            request.continuation.resume(failure);
+        }
+        else if (!complete) stream.abort();
+        else if (request.continuation.awaiting()) {
+            request.continuation.resume();
+        }
+
+        co_return complete;
+    }
+
+    auto session::read_body_data() -> ext::task<bool> {
+        if (!continue_sent) {
+            continue_sent = true;
+
+            // The client is waiting for permission to send the body; if the
+            // handler has already answered, there is no point in asking.
+            if (finished) co_return false;
+
+            batch.append(continue_response.data(), continue_response.size());
+            co_await socket.write(batch.iov());
+            batch.clear();
+        }
+
+        deadline.arm(timeouts.body);
+        const auto more = co_await read();
+        deadline.cancel();
+
+        co_return more;
+    }
+
+    auto session::read_head() -> ext::task<std::optional<std::string_view>> {
+        partial.clear();
+
+        while (true) {
+            idle = partial.empty() && !draining;
+
+            if (pending.empty()) {
+                // Once a request has started, its whole head must arrive
+                // before the header timeout, however slowly it trickles in.
+                if (partial.empty()) {
+                    deadline.arm(
+                        requests == 1 ? timeouts.header : timeouts.idle
+                    );
+                }
+
+                if (!co_await read()) {
+                    deadline.cancel();
+
+                    if (!partial.empty()) {
+                        TIMBER_DEBUG(
+                            "{} closed with an incomplete request",
+                            *this
+                        );
+                    }
+
+                    co_return std::nullopt;
+                }
+            }
+
+            idle = false;
+
+            const auto input = as_string(pending);
+            auto head = std::string_view();
+
+            if (partial.empty()) {
+                if (const auto size = head_size(input)) {
+                    head = input.substr(0, size);
+                    pending = pending.subspan(size);
+                }
+                else {
+                    partial.assign(input);
+                    pending = std::span<const std::byte>();
+
+                    deadline.arm(timeouts.header);
+                }
+            }
+            else {
+                const auto offset = partial.size();
+                partial.append(input);
+
+                if (const auto size = head_size(partial)) {
+                    head = std::string_view(partial).substr(0, size);
+                    pending = pending.subspan(size - offset);
+                }
+                else pending = std::span<const std::byte>();
+            }
+
+            const auto size = head.empty() ? partial.size() : head.size();
+
+            if (size > options.max_head_size) {
+                throw error_code(431, "Request header fields too large");
+            }
+
+            if (!head.empty()) {
+                deadline.cancel();
+                co_return stream.store(head);
+            }
+        }
+    }
+
+    auto session::produce(streaming_body& body, bool chunked)
+        -> ext::task<bool> {
+        auto& writer = *body.writer;
+
+        writer.set_sink([this, chunked](std::string_view data) {
+            return write_chunk(data, chunked);
+        });
+
+        try {
+            co_await body.producer(writer);
+        }
+        catch (const std::exception& ex) {
+            TIMBER_ERROR(
+                "Stream ID {} body producer failed: {}",
+                stream.id,
+                ex.what()
+            );
+
+            co_return false;
+        }
+
+        if (chunked) {
+            batch.append(last_chunk.data(), last_chunk.size());
+            co_await socket.write(batch.iov());
+            batch.clear();
+        }
+
+        co_return true;
+    }
+
+    auto session::recv() -> ext::task<> {
+        while (true) {
+            auto failure = std::optional<error_code>();
+            auto line = request_line();
+            auto info = head_info();
+
+            try {
+                const auto head = co_await read_head();
+                if (!head) co_return;
+
+                // The head was copied into the stream's arena, which the
+                // request views may point into; fields are parsed in place.
+                auto count = std::size_t();
+                auto size = std::size_t();
+                auto hosts = 0;
+
+                info = parse_head(
+                    std::span(const_cast<char*>(head->data()), head->size()),
+                    line,
+                    [&](std::string_view name, std::string_view value) {
+                        size += name.size() + value.size() + 32;
+
+                        if (++count > limits.max_header_count ||
+                            size > limits.max_header_list_size) {
+                            throw error_code(
+                                431,
+                                "Request header fields too large"
+                            );
+                        }
+
+                        if (name == "host") {
+                            if (++hosts > 1) {
+                                throw error_code(400, "Multiple Host headers");
+                            }
+
+                            stream.set_header(":authority", value);
+                        }
+                        else stream.set_header(name, value);
+                    }
+                );
+
+                if (hosts == 0 && line.minor_version >= 1) {
+                    throw error_code(400, "Missing Host header");
+                }
+
+                // The authority of an absolute-form target replaces Host.
+                if (!line.authority.empty()) {
+                    stream.set_header(":authority", line.authority);
+                }
+
+                if (info.chunked && info.content_length) {
+                    throw error_code(400, "Conflicting message framing");
+                }
+
+                // HTTP/1.0 has no transfer codings to rely on for framing.
+                if (info.chunked && line.minor_version == 0) {
+                    throw error_code(400, "Transfer encoding in HTTP/1.0");
+                }
+
+                stream.set_header(":method", line.method);
+                stream.set_header(
+                    ":scheme",
+                    socket.encrypted() ? "https" : "http"
+                );
+                stream.recv_path(line.target);
+            }
+            catch (const error_code& error) {
+                failure = error;
+            }
+
+            if (failure) {
+                co_await fail(*failure);
+                co_return;
+            }
+
+            const auto body = info.chunked || info.content_length.value_or(0);
+
+            stream.request.eof = !body;
+            continue_sent = !info.expect_continue;
+            finished = false;
+
+            if (auto permit = admit(admission)) {
+                handle_request(std::move(*permit));
+            }
+            else refuse();
+
+            auto complete = true;
+
+            // A body refused before the handler read any of it is not worth
+            // receiving; the connection closes instead.
+            const auto status = stream.response.status;
+
+            if (body && finished && (status == 413 || status == 503)) {
+                complete = false;
+            }
+            else if (body) complete = co_await read_body(info);
+
+            if (!finished) co_await done;
+            if (!stream.open) co_return;
+
+            // Without chunked encoding, the end of a streamed body can only
+            // be signalled by closing the connection.
+            const auto delimited = line.minor_version >= 1 ||
+                !std::holds_alternative<streaming_body>(stream.response.data);
+
+            const auto keep_alive =
+                info.keep_alive && complete && delimited && !draining;
+
+            if (!co_await respond(line, keep_alive) || !keep_alive) co_return;
+
+            stream.clear();
+            stream.id = ++requests;
+            TIMBER_TRACE("Stream ID {} opened", stream.id);
+        }
+    }
+
+    auto session::recv_chunked() -> ext::task<bool> {
+        auto decoder = chunked_decoder();
+
+        while (!decoder.done()) {
+            if (pending.empty() && !co_await read_body_data()) co_return false;
+
+            auto input = as_string(pending);
+
+            if (!partial.empty()) {
+                // Complete the control line that was split across reads
+                // before decoding from the socket buffer again.
+                const auto lf = detail::find(input, '\n');
+                const auto size =
+                    lf == std::string_view::npos ? input.size() : lf + 1;
+
+                partial.append(input.substr(0, size));
+                pending = pending.subspan(size);
+
+                if (lf == std::string_view::npos) {
+                    if (partial.size() > options.max_head_size) {
+                        throw error_code(400, "Malformed chunked encoding");
+                    }
+
+                    continue;
+                }
+
+                auto line = std::string_view(partial);
+                while (const auto data = decoder.decode(line)) {
+                    co_await deliver(as_bytes(*data));
+                }
+
+                partial.clear();
+                continue;
+            }
+
+            while (const auto data = decoder.decode(input)) {
+                co_await deliver(as_bytes(*data));
+            }
+
+            if (decoder.done()) pending = pending.last(input.size());
+            else {
+                partial.assign(input);
+                pending = std::span<const std::byte>();
+            }
+        }
+
+        co_return true;
+    }
+
+    auto session::recv_length(std::size_t length) -> ext::task<bool> {
+        while (length > 0) {
+            if (pending.empty() && !co_await read_body_data()) co_return false;
+
+            const auto data = pending.first(std::min(length, pending.size()));
+
+            pending = pending.subspan(data.size());
+            length -= data.size();
+
+            co_await deliver(data);
+        }
+
+        co_return true;
+    }
+
+    auto session::refuse() -> void {
+        TIMBER_DEBUG("{} refused request: server at capacity", *this);
+
+        counters->refuse();
+
+        stream.response.status = 503;
+        stream.response.headers.emplace("retry-after", "1");
+
+        finished = true;
+    }
+
+    auto session::respond(const request_line& line, bool keep_alive)
+        -> pooled_task<bool> {
+        auto& res = stream.response;
+        auto* const streaming = std::get_if<streaming_body>(&res.data);
+        const auto chunked = streaming && line.minor_version >= 1;
+
+        const auto header = [this](
+                                std::string_view name,
+                                std::string_view value
+                            ) {
+            batch.append(name.data(), name.size());
+            batch.append(": ", 2);
+            batch.append(value.data(), value.size());
+            batch.append(crlf.data(), crlf.size());
+        };
+
+        const auto length = std::visit(
+            []<typename T>(const T& t) -> std::size_t {
+                if constexpr (std::same_as<T, std::string>) return t.size();
+                else if constexpr (std::same_as<T, file>) return t.size;
+                else return 0;
+            },
+            res.data
+        );
+
+        if (has_body(res.status)) {
+            if (chunked) res.headers.emplace("transfer-encoding", "chunked");
+            else if (!streaming) res.headers.emplace("content-length", length);
+        }
+
+        const auto status = status_string(res.status);
+        const auto text = reason(res.status);
+
+        batch.append("HTTP/1.1 ", 9);
+        batch.append(status.data(), status.size());
+        batch.append(" ", 1);
+        batch.append(text.data(), text.size());
+        batch.append(crlf.data(), crlf.size());
+
+        for (const auto& field : res.headers) header(field.name, field.value);
+
+        if (!keep_alive) header("connection", "close");
+        else if (line.minor_version == 0) header("connection", "keep-alive");
+
+        batch.append(crlf.data(), crlf.size());
+
+        const auto* const file = std::get_if<server::file>(&res.data);
+        const auto body = has_body(res.status) && line.method != "HEAD";
+
+        if (body) {
+            if (const auto* string = std::get_if<std::string>(&res.data)) {
+                batch.reference(string->data(), string->size());
+            }
+        }
+
+        socket.cork();
+
+        co_await socket.write(batch.iov());
+        batch.clear();
+
+        if (body && file) {
+            const auto fd = file->descriptor();
+
+            if (socket.can_sendfile()) {
+                co_await socket.sendfile(fd, file->offset, file->size);
+            }
+            else {
+                auto buffer = std::vector<std::byte>(file_buffer_size);
+                auto remaining = file->size;
+
+                while (remaining > 0) {
+                    const auto ret = ::pread(
+                        fd,
+                        buffer.data(),
+                        std::min(remaining, buffer.size()),
+                        file->offset + file->size - remaining
+                    );
+
+                    if (ret == -1) {
+                        throw std::system_error(
+                            errno,
+                            std::generic_category(),
+                            fmt::format("Reading from fd ({}) failed", fd)
+                        );
+                    }
+
+                    if (ret == 0) {
+                        throw std::runtime_error(fmt::format(
+                            "fd ({}) ended {:L} bytes early",
+                            fd,
+                            remaining
+                        ));
+                    }
+
+                    auto iov = iovec {
+                        .iov_base = buffer.data(),
+                        .iov_len = static_cast<std::size_t>(ret)};
+
+                    co_await socket.write(std::span(&iov, 1));
+
+                    remaining -= ret;
+                }
+            }
+        }
+
+        socket.uncork();
+
+        TIMBER_DEBUG(
+            "Stream ID {} responded with status {}",
+            stream.id,
+            res.status
+        );
+
+        if (body && streaming) co_return co_await produce(*streaming, chunked);
+        co_return true;
+    }
+
+    auto session::time_out() -> void {
+        TIMBER_DEBUG("Stream ID {} handler timed out", stream.id);
+
+        // A response cannot be cancelled halfway, so the connection goes.
+        stream.open = false;
+
+        if (done.awaiting()) done.resume();
+        else if (closed.awaiting()) closed.resume();
+        else stream.abort();
+    }
+
+    auto session::unlink() noexcept -> void {
+        next->prev = prev;
+        prev->next = next;
+
+        next = this;
+        prev = this;
+    }
+
+    auto session::write_chunk(std::string_view data, bool chunked)
+        -> ext::task<> {
+        auto size = std::array<char, 16>();
+
+        if (chunked) {
+            const auto [ptr, ec] = std::to_chars(
+                size.data(),
+                size.data() + size.size(),
+                data.size(),
+                16
+            );
+
+            batch.append(size.data(), ptr - size.data());
+            batch.append(crlf.data(), crlf.size());
+        }
+
+        batch.reference(data.data(), data.size());
+
+        if (chunked) batch.append(crlf.data(), crlf.size());
+
+        co_await socket.write(batch.iov());
+        batch.clear();
+    }
+}
@@ -0,0 +1,49 @@
+#include <http/server/method.hpp>
+
+using namespace std::literals;
+
+namespace http::server {
+    auto parse_method(std::string_view method) noexcept -> method_type {
+        // Dispatch on length first so that at most two comparisons are made.
+        switch (method.size()) {
+            case 3:
+                if (method == "GET"sv) return method_type::get;
+                if (method == "PUT"sv) return method_type::put;
+                break;
+            case 4:
+                if (method == "POST"sv) return method_type::post;
+                if (method == "HEAD"sv) return method_type::head;
+                break;
+            case 5:
+                if (method == "PATCH"sv) return method_type::patch;
+                if (method == "TRACE"sv) return method_type::trace;
+                break;
+            case 6:
+                if (method == "DELETE"sv) return method_type::del;
+                break;
+            case 7:
+                if (method == "OPTIONS"sv) return method_type::options;
+                if (method == "CONNECT"sv) return method_type::connect;
+                break;
+        }
+
+        return method_type::extension;
+    }
+
+    auto to_string(method_type method) noexcept -> std::string_view {
+        switch (method) {
+            case method_type::connect: return "CONNECT";
+            case method_type::del: return "DELETE";
+            case method_type::get: return "GET";
+            case method_type::head: return "HEAD";
+            case method_type::options: return "OPTIONS";
+            case method_type::patch: return "PATCH";
+            case method_type::post: return "POST";
+            case method_type::put: return "PUT";
+            case method_type::trace: return "TRACE";
+            case method_type::extension: break;
+        }
+
+        return {};
+    }
+}
@@ -0,0 +1,32 @@
+#include <http/server/method_router.hpp>
+
+#include <gtest/gtest.h>
+
+using http::server::method_type;
+using http::server::parse_method;
+
+TEST(Method, Parse) {
+    for (auto i = std::size_t(); i < http::server::method_count; ++i) {
+        const auto type = static_cast<method_type>(i);
+        EXPECT_EQ(type, parse_method(to_string(type)));
+    }
+
+    EXPECT_EQ(method_type::extension, parse_method("PROPFIND"));
+    EXPECT_EQ(method_type::extension, parse_method("get"));
+    EXPECT_EQ(method_type::extension, parse_method(""));
+}
+
+TEST(Method, Router) {
+    auto router = http::server::method_router();
+
+    router.get([] {});
+    router.post([] {});
+    router.use("PURGE", [] {});
+
+    EXPECT_TRUE(router.find(method_type::get, "GET"));
+    EXPECT_TRUE(router.find("POST"));
+    EXPECT_TRUE(router.find("PURGE"));
+    EXPECT_FALSE(router.find(method_type::put, "PUT"));
+    EXPECT_FALSE(router.find("PROPFIND"));
+    EXPECT_EQ("GET, POST, PURGE", router.allowed());
+}
@@ -1,32 +1,89 @@
 #include <http/server/method_router.hpp>
 
 namespace http::server {
-    auto method_router::allowed() -> std::string_view {
-        if (cache_invalid) {
-            allowed_cache = std::as_const(*this).allowed();
-            cache_invalid = false;
-        }
-
-        return allowed_cache;
+    auto method_router::admit() noexcept
+        -> std::optional<concurrency_limit::permit> {
+        return server::admit(admission.get());
     }
 
-    auto method_router::allowed() const -> std::string {
-        auto methods = std::vector<std::string_view>();
-        methods.reserve(this->methods.size());
+    auto method_router::allowed() const noexcept -> std::string_view {
+        return allow;
+    }
 
-        for (const auto& entry : this->methods) {
-            methods.push_back(entry.first);
-        }
+    auto method_router::compress(const compression_options& options)
+        -> method_router& {
+        compression_opts = options;
+        return *this;
+    }
 
-        std::sort(methods.begin(), methods.end());
+    auto method_router::compression() const noexcept
+        -> const std::optional<compression_options>& {
+        return compression_opts;
+    }
 
-        return fmt::format("{}", fmt::join(methods, ", "));
+    auto method_router::concurrency(const admission_options& options)
+        -> method_router& {
+        admission = std::make_unique<concurrency_limit>(options);
+        return *this;
     }
 
     auto method_router::find(std::string_view method) -> handler* {
-        auto result = methods.find(method);
+        return find(parse_method(method), method);
+    }
 
-        if (result == methods.end()) return nullptr;
+    auto method_router::find(method_type type, std::string_view method)
+        -> handler* {
+        if (type != method_type::extension) {
+            return methods[static_cast<std::size_t>(type)].get();
+        }
+
+        if (extensions.empty()) return nullptr;
+
+        const auto result = extensions.find(method);
+
+        if (result == extensions.end()) return nullptr;
         return result->second.get();
     }
+
+    auto method_router::limit(const limit_options& options) -> method_router& {
+        limit_opts = options;
+        return *this;
+    }
+
+    auto method_router::limits() const noexcept
+        -> const std::optional<limit_options>& {
+        return limit_opts;
+    }
+
+    auto method_router::use(
+        std::string_view method,
+        std::unique_ptr<handler>&& handler
+    ) -> method_router& {
+        const auto type = parse_method(method);
+
+        if (type == method_type::extension) {
+            extensions.emplace(method, std::move(handler));
+        }
+        else {
+            auto& slot = methods[static_cast<std::size_t>(type)];
+            if (!slot) slot = std::move(handler);
+        }
+
+        // Routes are built once, so the allow header for a 405 response is
+        // assembled here rather than per request.
+        auto names = std::vector<std::string_view>();
+
+        for (auto i = std::size_t(); i < method_count; ++i) {
+            if (methods[i]) {
+                names.push_back(to_string(static_cast<method_type>(i)));
+            }
+        }
+
+        for (const auto& entry : extensions) names.push_back(entry.first);
+
+        std::sort(names.begin(), names.end());
+        allow = fmt::format("{}", fmt::join(names, ", "));
+
+        return *this;
+    }
 }
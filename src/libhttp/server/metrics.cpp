@@ -0,0 +1,39 @@
+#include <http/server/metrics.hpp>
+
+namespace http::server {
+    auto metrics::operator+=(const metrics& other) noexcept -> metrics& {
+        connections += other.connections;
+        active_connections += other.active_connections;
+        requests += other.requests;
+        refused += other.refused;
+
+        return *this;
+    }
+
+    auto counters::connection_closed() noexcept -> void {
+        closed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto counters::connection_opened() noexcept -> void {
+        connections.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto counters::refuse() noexcept -> void {
+        refused.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto counters::request() noexcept -> void {
+        requests.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto counters::snapshot() const noexcept -> metrics {
+        const auto closed = this->closed.load(std::memory_order_relaxed);
+        const auto opened = connections.load(std::memory_order_relaxed);
+
+        return {
+            .connections = opened,
+            .active_connections = opened - closed,
+            .requests = requests.load(std::memory_order_relaxed),
+            .refused = refused.load(std::memory_order_relaxed)};
+    }
+}
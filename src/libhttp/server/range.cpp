@@ -0,0 +1,277 @@
+#include <http/server/range.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <ext/string.h>
+#include <random>
+#include <unistd.h>
+
+using namespace std::literals;
+
+namespace {
+    constexpr auto max_ranges = std::size_t(16);
+    constexpr auto part_buffer_size = std::size_t(64 * 1024);
+
+    struct part {
+        std::string header;
+        http::server::byte_range range;
+    };
+
+    auto make_boundary() -> std::string {
+        thread_local auto engine = std::mt19937_64(std::random_device()());
+        return fmt::format("{:016x}{:016x}", engine(), engine());
+    }
+
+    auto parse_size(std::string_view string) noexcept
+        -> std::optional<std::size_t> {
+        auto result = std::size_t();
+
+        const auto* const end = string.data() + string.size();
+        const auto [ptr, ec] = std::from_chars(string.data(), end, result);
+
+        if (string.empty() || ec != std::errc() || ptr != end) {
+            return std::nullopt;
+        }
+
+        return result;
+    }
+
+    auto satisfies(
+        std::string_view if_range,
+        const http::server::header_list& headers
+    ) -> bool {
+        if_range = ext::trim(if_range);
+
+        // Entity tags require a strong comparison; anything else is a date,
+        // which must match the validator exactly.
+        if (if_range.starts_with("W/")) return false;
+
+        const auto* const validator = headers.find(
+            if_range.starts_with('"') ? "etag"sv : "last-modified"sv
+        );
+
+        return validator && !validator->value.starts_with("W/") &&
+               validator->value == if_range;
+    }
+
+    auto write_parts(
+        std::shared_ptr<const http::server::file> file,
+        std::vector<part> parts,
+        std::string trailer,
+        http::server::body_writer& out
+    ) -> ext::task<> {
+        auto buffer = std::vector<char>(part_buffer_size);
+        const auto fd = file->descriptor();
+
+        for (const auto& part : parts) {
+            co_await out.write(part.header);
+
+            auto position = file->offset + part.range.offset;
+            auto remaining = part.range.length;
+
+            while (remaining > 0) {
+                const auto ret = ::pread(
+                    fd,
+                    buffer.data(),
+                    std::min(remaining, buffer.size()),
+                    position
+                );
+
+                if (ret == -1) {
+                    throw std::system_error(
+                        errno,
+                        std::generic_category(),
+                        fmt::format("Reading from fd ({}) failed", fd)
+                    );
+                }
+
+                if (ret == 0) {
+                    throw std::runtime_error(fmt::format(
+                        "fd ({}) ended {:L} bytes early",
+                        fd,
+                        remaining
+                    ));
+                }
+
+                const auto size = static_cast<std::size_t>(ret);
+                co_await out.write(std::string_view(buffer.data(), size));
+
+                position += ret;
+                remaining -= ret;
+            }
+        }
+
+        co_await out.write(trailer);
+    }
+}
+
+namespace http::server {
+    auto parse_range(std::string_view header, std::size_t size)
+        -> std::optional<std::vector<byte_range>> {
+        header = ext::trim(header);
+
+        constexpr auto unit = "bytes="sv;
+        if (!header.starts_with(unit)) return std::nullopt;
+
+        const auto specs = header.substr(unit.size());
+        auto result = std::vector<byte_range>();
+
+        for (const auto item : ext::string_range(specs, ",")) {
+            const auto spec = ext::trim(item);
+            if (spec.empty()) continue;
+
+            const auto dash = spec.find('-');
+            if (dash == std::string_view::npos) return std::nullopt;
+
+            const auto first = spec.substr(0, dash);
+            const auto last = spec.substr(dash + 1);
+
+            if (first.empty()) {
+                const auto suffix = parse_size(last);
+                if (!suffix) return std::nullopt;
+
+                if (*suffix > 0 && size > 0) {
+                    const auto length = std::min(*suffix, size);
+                    result.push_back({size - length, length});
+                }
+            }
+            else {
+                const auto start = parse_size(first);
+                if (!start) return std::nullopt;
+
+                auto end = size == 0 ? 0 : size - 1;
+
+                if (!last.empty()) {
+                    const auto value = parse_size(last);
+                    if (!value || *value < *start) return std::nullopt;
+
+                    end = std::min(*value, end);
+                }
+
+                if (*start < size) {
+                    result.push_back({*start, end - *start + 1});
+                }
+            }
+
+            // Guard against requests made of many tiny ranges.
+            if (result.size() > max_ranges) return std::nullopt;
+        }
+
+        // Overlapping or adjacent ranges are merged (RFC 9110 §14.2) so that
+        // no byte is sent more than once.
+        std::ranges::sort(result, {}, &byte_range::offset);
+
+        auto merged = std::vector<byte_range>();
+
+        for (const auto& range : result) {
+            if (!merged.empty()) {
+                auto& last = merged.back();
+                const auto end = last.offset + last.length;
+
+                if (range.offset <= end) {
+                    const auto next = range.offset + range.length;
+                    last.length = std::max(end, next) - last.offset;
+                    continue;
+                }
+            }
+
+            merged.push_back(range);
+        }
+
+        return merged;
+    }
+
+    auto serve_range(const request& request, response& response) -> void {
+        auto* const file = std::get_if<server::file>(&response.data);
+        if (!file || response.status != 200) return;
+
+        auto& headers = response.headers;
+        headers.emplace("accept-ranges", "bytes");
+
+        if (request.verb != method_type::get) return;
+
+        const auto range = request.headers.find("range");
+        if (range == request.headers.end()) return;
+
+        const auto if_range = request.headers.find("if-range");
+        if (if_range != request.headers.end() &&
+            !satisfies(if_range->second, headers)) {
+            return;
+        }
+
+        const auto ranges = parse_range(range->second, file->size);
+        if (!ranges) return;
+
+        headers.erase("content-length");
+
+        if (ranges->empty()) {
+            response.status = 416;
+            headers.set("content-range", fmt::format("bytes */{}", file->size));
+            response.data = std::monostate();
+            return;
+        }
+
+        response.status = 206;
+
+        const auto size = file->size;
+        const auto content_range = [size](const byte_range& range) {
+            return fmt::format(
+                "bytes {}-{}/{}",
+                range.offset,
+                range.offset + range.length - 1,
+                size
+            );
+        };
+
+        if (ranges->size() == 1) {
+            const auto& range = ranges->front();
+
+            headers.set("content-range", content_range(range));
+
+            file->offset += range.offset;
+            file->size = range.length;
+
+            response.content_length(file->size);
+            return;
+        }
+
+        const auto boundary = make_boundary();
+        const auto* const type = headers.find("content-type");
+
+        auto parts = std::vector<part>();
+        parts.reserve(ranges->size());
+
+        for (const auto& range : *ranges) {
+            auto header = fmt::memory_buffer();
+            auto out = std::back_inserter(header);
+
+            if (!parts.empty()) fmt::format_to(out, "\r\n");
+            fmt::format_to(out, "--{}\r\n", boundary);
+
+            if (type) fmt::format_to(out, "content-type: {}\r\n", type->value);
+
+            fmt::format_to(
+                out,
+                "content-range: {}\r\n\r\n",
+                content_range(range)
+            );
+
+            parts.push_back({fmt::to_string(header), range});
+        }
+
+        headers.set(
+            "content-type",
+            fmt::format("multipart/byteranges; boundary={}", boundary)
+        );
+
+        auto source = std::make_shared<const server::file>(std::move(*file));
+        auto trailer = fmt::format("\r\n--{}--\r\n", boundary);
+
+        response.data = streaming_body {
+            .producer = [source = std::move(source),
+                         parts = std::move(parts),
+                         trailer = std::move(trailer)](body_writer& out) {
+                return write_parts(source, parts, trailer, out);
+            }};
+    }
+}
@@ -0,0 +1,64 @@
+#include <http/server/range.hpp>
+
+#include <gtest/gtest.h>
+
+using http::server::byte_range;
+using http::server::parse_range;
+
+using ranges = std::vector<byte_range>;
+
+TEST(Range, Single) {
+    EXPECT_EQ((ranges {{0, 500}}), parse_range("bytes=0-499", 10000));
+    EXPECT_EQ((ranges {{9500, 500}}), parse_range("bytes=9500-", 10000));
+    EXPECT_EQ((ranges {{9500, 500}}), parse_range("bytes=-500", 10000));
+    EXPECT_EQ((ranges {{0, 100}}), parse_range("bytes=-500", 100));
+    EXPECT_EQ((ranges {{50, 50}}), parse_range("bytes=50-1000", 100));
+}
+
+TEST(Range, Multiple) {
+    EXPECT_EQ(
+        (ranges {{0, 1}, {9999, 1}}),
+        parse_range("bytes=0-0, -1", 10000)
+    );
+
+    EXPECT_EQ(
+        (ranges {{500, 100}, {700, 300}}),
+        parse_range("bytes=500-599,,700-999", 10000)
+    );
+}
+
+TEST(Range, Coalesce) {
+    EXPECT_EQ(
+        (ranges {{0, 100}}),
+        parse_range("bytes=0-99, 0-99, 0-99, 0-", 100)
+    );
+
+    EXPECT_EQ((ranges {{0, 30}}), parse_range("bytes=10-19, 0-9, 20-29", 100));
+
+    EXPECT_EQ(
+        (ranges {{0, 20}, {50, 10}}),
+        parse_range("bytes=50-59, 5-19, 0-10", 100)
+    );
+
+    EXPECT_EQ((ranges {{90, 10}}), parse_range("bytes=-10, 95-", 100));
+}
+
+TEST(Range, Unsatisfiable) {
+    EXPECT_EQ(ranges(), parse_range("bytes=100-", 100));
+    EXPECT_EQ(ranges(), parse_range("bytes=-0", 100));
+    EXPECT_EQ(ranges(), parse_range("bytes=0-10", 0));
+    EXPECT_EQ((ranges {{0, 10}}), parse_range("bytes=200-300, 0-9", 100));
+}
+
+TEST(Range, Invalid) {
+    EXPECT_FALSE(parse_range("items=0-10", 100));
+    EXPECT_FALSE(parse_range("bytes=10-0", 100));
+    EXPECT_FALSE(parse_range("bytes=a-b", 100));
+    EXPECT_FALSE(parse_range("bytes=10", 100));
+    EXPECT_FALSE(parse_range("bytes=-", 100));
+
+    auto many = std::string("bytes=0-0");
+    for (auto i = 1; i <= 16; ++i) many += fmt::format(",{}-{}", i, i);
+
+    EXPECT_FALSE(parse_range(many, 100));
+}
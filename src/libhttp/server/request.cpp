@@ -1,6 +1,11 @@
 #include <http/server/request.hpp>
 
 namespace http::server {
+    request::request(std::pmr::memory_resource* resource) :
+        params(resource),
+        query(resource),
+        headers(resource) {}
+
     auto request::content_type() const -> media_type {
         return header<std::string_view>("content-type");
     }
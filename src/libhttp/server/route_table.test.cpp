@@ -0,0 +1,109 @@
+#include <http/server/route_table.hpp>
+
+#include <gtest/gtest.h>
+
+using http::server::route_table;
+
+namespace {
+    using tree = http::server::node<int>;
+
+    const auto routes = std::vector<std::pair<std::string_view, int>> {
+        {"/", 0},
+        {"/users", 1},
+        {"/users/:id", 2},
+        {"/users/:id/posts", 3},
+        {"/users/:id/posts/:post", 4},
+        {"/files/*path", 5},
+        {"/about", 6},
+        {"/api/v1/items/:item", 7},
+        {"/api/v2/items", 8},
+        {"/assets/*file", 9},
+    };
+
+    auto make_tree() -> tree {
+        auto result = tree();
+        for (auto [route, value] : routes) result.insert(route, value);
+        return result;
+    }
+
+    auto params(const route_table<int>::match& match)
+        -> std::map<std::string_view, std::string_view> {
+        return {match.params.begin(), match.params.end()};
+    }
+}
+
+TEST(RouteTable, Static) {
+    auto table = route_table<int>(make_tree());
+
+    EXPECT_EQ(routes.size(), table.size());
+    EXPECT_EQ(0, *table.find("/")->value);
+    EXPECT_EQ(1, *table.find("/users")->value);
+    EXPECT_EQ(1, *table.find("/users/")->value);
+    EXPECT_EQ(6, *table.find("/about")->value);
+    EXPECT_EQ(8, *table.find("/api/v2/items")->value);
+    EXPECT_FALSE(table.find("/abou"));
+    EXPECT_FALSE(table.find("/api/v3/items"));
+    EXPECT_FALSE(table.find("/nothing"));
+}
+
+TEST(RouteTable, Params) {
+    auto table = route_table<int>(make_tree());
+
+    auto match = table.find("/users/42/posts/7");
+    ASSERT_TRUE(match);
+    EXPECT_EQ(4, *match->value);
+    EXPECT_EQ(
+        (std::map<std::string_view, std::string_view> {
+            {"id", "42"},
+            {"post", "7"}}),
+        params(*match)
+    );
+
+    match = table.find("/files/a/b/c.txt");
+    ASSERT_TRUE(match);
+    EXPECT_EQ(5, *match->value);
+    EXPECT_EQ("a/b/c.txt", params(*match).at("path"));
+}
+
+TEST(RouteTable, MatchesTree) {
+    auto reference = make_tree();
+    auto table = route_table<int>(make_tree());
+
+    const auto paths = std::vector<std::string_view> {
+        "/",
+        "/users",
+        "/users/abc",
+        "/users/abc/",
+        "/users/abc/posts",
+        "/users/abc/posts/def",
+        "/users/abc/comments",
+        "/files/",
+        "/files/x",
+        "/about",
+        "/about/me",
+        "/api/v1/items/1",
+        "/api/v1/items",
+        "/api/v2/items",
+        "/assets/css/site.css",
+        "/a",
+        "",
+        "/unknown/path",
+    };
+
+    for (const auto path : paths) {
+        const auto expected = reference.find(path);
+        const auto actual = table.find(path);
+
+        ASSERT_EQ(expected.has_value(), actual.has_value()) << path;
+        if (!expected) continue;
+
+        EXPECT_EQ(*expected->value, *actual->value) << path;
+        EXPECT_EQ(
+            (std::map<std::string_view, std::string_view>(
+                expected->params.begin(),
+                expected->params.end()
+            )),
+            params(*actual)
+        ) << path;
+    }
+}
@@ -1,31 +1,96 @@
 #include <http/server/error.hpp>
+#include <http/server/range.hpp>
 #include <http/server/response/string.hpp>
 #include <http/server/router.hpp>
 
 #include <timber/timber>
 
+namespace {
+    auto header_list_size(const http::server::header_map& headers)
+        -> std::size_t {
+        auto size = std::size_t();
+
+        // Sized the way HTTP/2 accounts for SETTINGS_MAX_HEADER_LIST_SIZE.
+        for (const auto& [name, value] : headers) {
+            size += name.size() + value.size() + 32;
+        }
+
+        return size;
+    }
+
+    auto enforce(
+        http::server::request& request,
+        const std::optional<http::server::limit_options>& limits
+    ) -> void {
+        if (limits) {
+            if (request.headers.size() > limits->max_header_count ||
+                header_list_size(request.headers) >
+                    limits->max_header_list_size) {
+                throw http::error_code(431, "Request header fields too large");
+            }
+
+            request.max_body_size = limits->max_body_size;
+        }
+
+        if (!request.max_body_size) return;
+
+        // Refuse a declared body that is too large before the handler
+        // starts reading it.
+        const auto length =
+            request.header<std::optional<std::size_t>>("content-length");
+
+        if (length && *length > *request.max_body_size) {
+            throw http::error_code(
+                413,
+                "Request body exceeds {:L} bytes",
+                *request.max_body_size
+            );
+        }
+    }
+}
+
 namespace http::server {
-    router::router(path&& paths) : paths(std::forward<path>(paths)) {}
+    router::router(path&& paths) : table(std::forward<path>(paths)) {}
+
+    auto router::find(std::string_view path) -> std::optional<route_match> {
+        if (lookup) return lookup(path, routes);
+        return table.find(path);
+    }
 
-    auto router::route(stream& stream) -> ext::task<bool> {
-        auto match = paths.find(stream.request.path);
+    auto router::route(stream& stream) -> pooled_task<bool> {
+        auto match = find(stream.request.path);
         if (!match) {
             stream.response.status = 404;
             co_return true;
         }
 
-        stream.request.params = std::move(match->params);
+        stream.request.params.insert(
+            match->params.begin(),
+            match->params.end()
+        );
         auto& methods = *match->value;
 
-        auto* handler = methods.find(stream.request.method);
+        auto* handler = methods.find(stream.request.verb, stream.request.method);
         if (!handler) {
             stream.response.status = 405;
             stream.response.headers.emplace("allow", methods.allowed());
             co_return true;
         }
 
+        auto permit = methods.admit();
+        if (!permit) {
+            TIMBER_DEBUG("Stream ID {} refused: route at capacity", stream.id);
+
+            stream.response.status = 503;
+            stream.response.headers.emplace("retry-after", "1");
+            co_return true;
+        }
+
         try {
-            co_await handler->handle(stream);
+            enforce(stream.request, methods.limits());
+            if (!handler->try_handle(stream)) {
+                co_await handler->handle(stream);
+            }
         }
         catch (const stream_aborted&) {
             TIMBER_DEBUG("Stream ID {} aborted", stream.id);
@@ -56,6 +121,18 @@ namespace http::server {
             stream.response.status = 500;
         }
 
+        permit->release(stream.request.waiting);
+
+        if (!stream.open) co_return false;
+
+        serve_range(stream.request, stream.response);
+
+        const auto& compression = methods.compression();
+
+        if (compression) {
+            compress(stream.request, stream.response, *compression);
+        }
+
         co_return stream.open;
     }
 }
@@ -0,0 +1,84 @@
+#include <http/server/response/string.hpp>
+#include <http/server/router.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace std::literals;
+
+namespace {
+    auto home() -> std::string { return "home"; }
+
+    auto make_router(const http::server::limit_options& limits)
+        -> http::server::router {
+        auto methods = http::server::get(home);
+        methods.limit(limits);
+
+        auto paths = http::server::path();
+        paths.insert("/", std::move(methods));
+
+        return http::server::router(std::move(paths));
+    }
+
+    auto run(http::server::router& router, http::server::stream& stream)
+        -> http::server::pooled_detached_task {
+        co_await router.route(stream);
+    }
+
+    auto route(
+        http::server::router& router,
+        std::initializer_list<std::pair<std::string_view, std::string_view>>
+            headers
+    ) -> std::unique_ptr<http::server::stream> {
+        auto stream = std::make_unique<http::server::stream>();
+        auto& request = stream->request;
+
+        request.method = "GET";
+        request.verb = http::server::method_type::get;
+        request.path = "/";
+
+        for (const auto& [name, value] : headers) {
+            request.headers.emplace(name, value);
+        }
+
+        run(router, *stream);
+        return stream;
+    }
+}
+
+TEST(Router, HeaderCount) {
+    auto router = make_router({.max_header_count = 2});
+
+    EXPECT_EQ(200, route(router, {{"a", "1"}, {"b", "2"}})->response.status);
+    EXPECT_EQ(
+        431,
+        route(router, {{"a", "1"}, {"b", "2"}, {"c", "3"}})->response.status
+    );
+}
+
+TEST(Router, HeaderListSize) {
+    auto router = make_router({.max_header_list_size = 64});
+    const auto value = std::string(64, 'a');
+
+    EXPECT_EQ(200, route(router, {{"a", "1"}})->response.status);
+    EXPECT_EQ(431, route(router, {{"a", value}})->response.status);
+}
+
+TEST(Router, BodySize) {
+    auto router = make_router({.max_body_size = 10});
+
+    const auto accepted = route(router, {{"content-length", "10"}});
+    EXPECT_EQ(200, accepted->response.status);
+    EXPECT_EQ("home", std::get<std::string>(accepted->response.data));
+
+    const auto rejected = route(router, {{"content-length", "11"}});
+    EXPECT_EQ(413, rejected->response.status);
+    EXPECT_EQ(10, rejected->request.max_body_size);
+}
+
+TEST(Router, BodySizeUnlimited) {
+    auto router = make_router({});
+
+    const auto stream = route(router, {{"content-length", "1073741824"}});
+    EXPECT_EQ(200, stream->response.status);
+    EXPECT_FALSE(stream->request.max_body_size);
+}
@@ -0,0 +1,84 @@
+#include <http/server/response/string.hpp>
+#include <http/server/routing.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace http::server::routing;
+using namespace http::server::extractor;
+
+namespace {
+    auto index() -> std::string { return "index"; }
+
+    auto user(path<"id"> id) -> std::string {
+        return fmt::format("user {}", *id);
+    }
+
+    auto post(path<"id"> id, path<"post", int> post) -> std::string {
+        return fmt::format("user {} post {}", *id, *post);
+    }
+
+    auto file(path<"path"> path) -> std::string {
+        return std::string(*path);
+    }
+
+    using routes = table<
+        route<"/", get<index>>,
+        route<"/users/:id", get<user>>,
+        route<"/users/me", get<index>>,
+        route<"/users/:id/posts/:post", get<post>, del<post>>,
+        route<"/files/*path", get<file>>,
+        route<"/about", get<index>>>;
+
+    auto params(const http::server::route_table<
+                http::server::method_router>::match& match)
+        -> std::map<std::string_view, std::string_view> {
+        return {match.params.begin(), match.params.end()};
+    }
+}
+
+TEST(Routing, Static) {
+    auto values = routes::handlers();
+
+    EXPECT_EQ(&values[0], routes::find("/", values)->value);
+    EXPECT_EQ(&values[2], routes::find("/users/me", values)->value);
+    EXPECT_EQ(&values[2], routes::find("/users/me/", values)->value);
+    EXPECT_EQ(&values[5], routes::find("/about", values)->value);
+    EXPECT_FALSE(routes::find("/abou", values));
+    EXPECT_FALSE(routes::find("/users", values));
+    EXPECT_FALSE(routes::find("", values));
+}
+
+TEST(Routing, Params) {
+    auto values = routes::handlers();
+
+    auto match = routes::find("/users/42", values);
+    ASSERT_TRUE(match);
+    EXPECT_EQ(&values[1], match->value);
+    EXPECT_EQ("42", params(*match).at("id"));
+
+    match = routes::find("/users/42/posts/7", values);
+    ASSERT_TRUE(match);
+    EXPECT_EQ(&values[3], match->value);
+    EXPECT_EQ(
+        (std::map<std::string_view, std::string_view> {
+            {"id", "42"},
+            {"post", "7"}}),
+        params(*match)
+    );
+
+    match = routes::find("/files/css/site.css", values);
+    ASSERT_TRUE(match);
+    EXPECT_EQ(&values[4], match->value);
+    EXPECT_EQ("css/site.css", params(*match).at("path"));
+
+    EXPECT_FALSE(routes::find("/users/42/posts", values));
+    EXPECT_FALSE(routes::find("/users/42/comments/7", values));
+}
+
+TEST(Routing, Methods) {
+    auto values = routes::handlers();
+
+    EXPECT_TRUE(values[3].find("GET"));
+    EXPECT_TRUE(values[3].find("DELETE"));
+    EXPECT_FALSE(values[3].find("POST"));
+}
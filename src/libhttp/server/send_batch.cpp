@@ -0,0 +1,56 @@
+#include <http/server/send_batch.hpp>
+
+#include <cstring>
+
+namespace http::server {
+    auto send_batch::append(const void* data, std::size_t size) -> void {
+        if (size == 0) return;
+
+        const auto offset = storage.size();
+
+        storage.resize(offset + size);
+        std::memcpy(&storage[offset], data, size);
+        bytes += size;
+
+        segments.push_back({.data = nullptr, .offset = offset, .size = size});
+    }
+
+    auto send_batch::clear() noexcept -> void {
+        storage.clear();
+        segments.clear();
+        vectors.clear();
+        bytes = 0;
+    }
+
+    auto send_batch::empty() const noexcept -> bool { return segments.empty(); }
+
+    auto send_batch::iov() -> std::span<iovec> {
+        vectors.clear();
+        vectors.reserve(segments.size());
+
+        for (const auto& segment : segments) {
+            const auto* const data =
+                segment.data ? segment.data : &storage[segment.offset];
+
+            vectors.push_back(
+                {.iov_base = const_cast<std::byte*>(data),
+                 .iov_len = segment.size}
+            );
+        }
+
+        return vectors;
+    }
+
+    auto send_batch::reference(const void* data, std::size_t size) -> void {
+        if (size == 0) return;
+
+        segments.push_back(
+            {.data = static_cast<const std::byte*>(data),
+             .offset = 0,
+             .size = size}
+        );
+        bytes += size;
+    }
+
+    auto send_batch::size() const noexcept -> std::size_t { return bytes; }
+}
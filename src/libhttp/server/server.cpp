@@ -1,39 +1,227 @@
 #include <http/server/server.hpp>
 #include <http/server/session.hpp>
 
-#include <ext/data_size.h>
+#include <ext/scope>
+#include <fmt/chrono.h>
+#include <memory>
 
-using namespace ext::literals;
+namespace {
+    auto make_option(const http::server::http2_options& options)
+        -> nghttp2_option* {
+        nghttp2_option* option = nullptr;
+
+        if (const auto rv = nghttp2_option_new(&option); rv != 0) {
+            throw std::runtime_error(nghttp2_strerror(rv));
+        }
+
+        // Window updates are sent as handlers read request bodies so that a
+        // slow reader only holds back its own stream.
+        nghttp2_option_set_no_auto_window_update(option, 1);
+
+        // Clients may reprioritize streams with PRIORITY_UPDATE frames once
+        // SETTINGS_NO_RFC7540_PRIORITIES has been sent.
+        nghttp2_option_set_builtin_recv_extension_type(
+            option,
+            NGHTTP2_PRIORITY_UPDATE
+        );
+
+        if (options.max_deflate_dynamic_table_size) {
+            nghttp2_option_set_max_deflate_dynamic_table_size(
+                option,
+                *options.max_deflate_dynamic_table_size
+            );
+        }
+
+        if (options.max_send_header_block_length) {
+            nghttp2_option_set_max_send_header_block_length(
+                option,
+                *options.max_send_header_block_length
+            );
+        }
+
+        if (options.max_outbound_ack) {
+            nghttp2_option_set_max_outbound_ack(
+                option,
+                *options.max_outbound_ack
+            );
+        }
+
+        if (options.max_settings) {
+            nghttp2_option_set_max_settings(option, *options.max_settings);
+        }
+
+        return option;
+    }
+
+    auto reclaim(std::unique_ptr<http::server::http1::session> session)
+        -> ext::detached_task {
+        co_await session->await_handlers();
+    }
+}
 
 namespace http::server {
-    context::context() : buffer_size(8_KiB), router(nullptr) {}
+    auto detail::option_deleter::operator()(nghttp2_option* option
+    ) const noexcept -> void {
+        nghttp2_option_del(option);
+    }
+
+    context::context() : router(nullptr) {}
 
-    context::context(http::server::router& router) : context(router, 8_KiB) {}
+    context::context(http::server::router& router) :
+        context(router, http::server::options()) {}
 
     context::context(http::server::router& router, std::size_t buffer_size) :
-        buffer_size(buffer_size),
-        router(&router) {}
+        context(router, http::server::options {.buffer_size = buffer_size}) {}
+
+    context::context(
+        http::server::router& router,
+        const http::server::options& options
+    ) :
+        context(
+            router,
+            options,
+            options.admission
+                ? std::make_shared<concurrency_limit>(*options.admission)
+                : nullptr
+        ) {}
+
+    context::context(
+        http::server::router& router,
+        const http::server::options& options,
+        std::shared_ptr<concurrency_limit> admission
+    ) :
+        options(options),
+        option(make_option(options.http2)),
+        router(&router),
+        admission(std::move(admission)) {}
+
+    auto context::connection(netcore::socket&& client) -> ext::task<> {
+        co_await serve_http2(http::server::socket(
+            std::forward<netcore::socket>(client),
+            options.buffer_size
+        ));
+    }
 
     auto context::connection(netcore::ssl::socket&& client) -> ext::task<> {
         const auto protocol = co_await client.accept();
 
-        if (protocol != "h2") {
-            throw std::runtime_error("Protocol h2 not negotiated");
+        auto socket = http::server::socket(
+            std::forward<netcore::ssl::socket>(client),
+            options.buffer_size
+        );
+
+        if (protocol == "h2") co_await serve_http2(std::move(socket));
+        else co_await serve_http1(std::move(socket));
+    }
+
+    auto context::connection_closed() -> void {
+        counters.connection_closed();
+
+        if (!draining) return;
+
+        const auto remaining = counters.snapshot().active_connections;
+
+        if (remaining > 0) {
+            TIMBER_DEBUG(
+                "HTTP server draining: {:L} connection{} remaining",
+                remaining,
+                remaining == 1 ? "" : "s"
+            );
+            return;
         }
 
+        TIMBER_INFO("HTTP server drained");
+
+        draining = false;
+        deadline->cancel();
+    }
+
+    auto context::drain() -> ext::detached_task {
+        auto& timer = deadline.emplace(netcore::timer::monotonic());
+        timer.set(options.drain_timeout);
+
+        if (co_await timer.wait() == 0 || !draining) co_return;
+
+        draining = false;
+
+        TIMBER_WARNING(
+            "HTTP server drain deadline reached: closing {:L} connections",
+            counters.snapshot().active_connections
+        );
+
+        sessions.close();
+        http1_sessions.close();
+    }
+
+    auto context::metrics() const noexcept -> http::server::metrics {
+        return counters.snapshot();
+    }
+
+    auto context::serve_http1(http::server::socket&& socket) -> ext::task<> {
+        auto session = std::make_unique<http1::session>(
+            std::forward<http::server::socket>(socket),
+            options,
+            *router,
+            counters,
+            admission.get()
+        );
+
+        http1_sessions.link(*session);
+        counters.connection_opened();
+
+        const auto closed = ext::scope_exit([this] { connection_closed(); });
+
+        co_await session->handle_connection();
+
+        // A handler that ignored its timeout keeps its session, but not the
+        // connection, until it returns.
+        if (session->abandoned()) reclaim(std::move(session));
+    }
+
+    auto context::serve_http2(http::server::socket&& socket) -> ext::task<> {
         auto session = http::server::session(
-            std::forward<netcore::ssl::socket>(client),
-            buffer_size,
-            *router
+            std::forward<http::server::socket>(socket),
+            options,
+            option.get(),
+            *router,
+            counters,
+            admission.get()
         );
 
         sessions.link(session);
+        counters.connection_opened();
+
+        const auto closed = ext::scope_exit([this] { connection_closed(); });
 
         co_await session.handle_connection();
     }
 
     auto context::shutdown() -> void {
         TIMBER_DEBUG("HTTP server shutdown requested");
-        sessions.close();
+
+        const auto active = counters.snapshot().active_connections;
+
+        if (active == 0 || options.drain_timeout.count() <= 0) {
+            sessions.close();
+            http1_sessions.close();
+            return;
+        }
+
+        if (draining) return;
+
+        TIMBER_INFO(
+            "HTTP server draining {:L} connection{} (deadline: {})",
+            active,
+            active == 1 ? "" : "s",
+            options.drain_timeout
+        );
+
+        // Stop accepting new streams and let in-flight requests finish;
+        // whatever remains when the deadline passes is closed.
+        draining = true;
+        drain();
+
+        sessions.drain();
+        http1_sessions.drain();
     }
 }
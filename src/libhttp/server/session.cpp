@@ -1,3 +1,4 @@
+#include <http/server/response/string.hpp>
 #include <http/server/session.hpp>
 
 #include <netcore/netcore>
@@ -5,6 +6,10 @@
 using namespace std::literals;
 
 namespace {
+    // Frames at least this large are written straight from nghttp2's buffer
+    // instead of being copied into the batch.
+    constexpr auto max_copy = std::size_t(1024);
+
     auto make_nv(
         std::string_view name,
         std::string_view value,
@@ -34,25 +39,39 @@ namespace {
                 ssize_t written = 0;
 
                 if constexpr (std::same_as<T, std::string>) {
-                    const auto max = std::min(t.size() - res.written, length);
-
-                    written =
-                        t.copy(reinterpret_cast<char*>(buf), max, res.written);
+                    written = std::min(t.size() - res.written, length);
 
-                    res.written += written;
+                    *data_flags |= NGHTTP2_DATA_FLAG_NO_COPY;
 
-                    if (res.written == t.size()) {
+                    if (res.written + written == t.size()) {
                         *data_flags |= NGHTTP2_DATA_FLAG_EOF;
                     }
                 }
                 else if constexpr (std::same_as<T, http::server::file>) {
                     const auto max = std::min(t.size - res.written, length);
 
-                    const auto ret = read(t.fd, buf, max);
+                    auto& session =
+                        *reinterpret_cast<http::server::session*>(user_data);
+
+                    if (session.can_sendfile()) {
+                        *data_flags |= NGHTTP2_DATA_FLAG_NO_COPY;
+
+                        if (res.written + max == t.size) {
+                            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+                        }
+
+                        return max;
+                    }
+
+                    // Cached descriptors are shared between responses, so
+                    // the file position cannot be relied upon.
+                    const auto fd = t.descriptor();
+                    const auto ret =
+                        pread(fd, buf, max, t.offset + res.written);
                     if (ret == -1) {
                         TIMBER_ERROR(
                             "Reading from fd ({}) failed: {}",
-                            t.fd,
+                            fd,
                             strerror(errno)
                         );
                         return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
@@ -63,7 +82,7 @@ namespace {
 
                     TIMBER_TRACE(
                         "fd ({}) read {:L} byte{} ({:L} remaining)",
-                        t.fd,
+                        fd,
                         ret,
                         ret == 1 ? "" : "s",
                         t.size - res.written
@@ -73,6 +92,26 @@ namespace {
                         *data_flags |= NGHTTP2_DATA_FLAG_EOF;
                     }
                 }
+                else if constexpr (std::same_as<
+                                       T,
+                                       http::server::streaming_body>) {
+                    auto& writer = *t.writer;
+                    const auto pending = writer.pending();
+
+                    if (pending.empty()) {
+                        if (writer.done()) {
+                            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+                            return 0;
+                        }
+
+                        // Nothing to send until the producer writes again.
+                        writer.defer();
+                        return NGHTTP2_ERR_DEFERRED;
+                    }
+
+                    written = std::min(pending.size(), length);
+                    *data_flags |= NGHTTP2_DATA_FLAG_NO_COPY;
+                }
 
                 return written;
             },
@@ -80,6 +119,44 @@ namespace {
         );
     }
 
+    auto send_data_callback(
+        nghttp2_session* handle,
+        nghttp2_frame* frame,
+        const std::uint8_t* framehd,
+        std::size_t length,
+        nghttp2_data_source* source,
+        void* user_data
+    ) -> int {
+        auto& session = *reinterpret_cast<http::server::session*>(user_data);
+        auto& res = *reinterpret_cast<http::server::response*>(source->ptr);
+        const auto offset = std::exchange(res.written, res.written + length);
+
+        if (const auto* string = std::get_if<std::string>(&res.data)) {
+            session.send_data(framehd, string->data() + offset, length);
+            return 0;
+        }
+
+        if (auto* body = std::get_if<http::server::streaming_body>(&res.data)) {
+            auto& writer = *body->writer;
+
+            session.send_data(framehd, writer.pending().data(), length);
+            if (writer.consume(length)) session.drain(writer);
+
+            return 0;
+        }
+
+        session.send_file(
+            framehd,
+            std::get<http::server::file>(res.data),
+            offset,
+            length
+        );
+
+        // Return control to the send loop so that the file contents can be
+        // written before any frames that follow.
+        return NGHTTP2_ERR_PAUSE;
+    }
+
     auto on_begin_headers_callback(
         nghttp2_session* handle,
         const nghttp2_frame* frame,
@@ -109,19 +186,29 @@ namespace {
         size_t len,
         void* user_data
     ) -> int {
-        auto& stream = *reinterpret_cast<http::server::stream*>(
+        // The connection window is returned as soon as the data is buffered;
+        // only the stream's own window waits for its handler to read it.
+        nghttp2_session_consume_connection(handle, len);
+
+        auto* const data_stream = reinterpret_cast<http::server::stream*>(
             nghttp2_session_get_stream_user_data(handle, stream_id)
         );
 
-        auto& request = stream.request;
+        if (!data_stream) return 0;
 
-        if (request.discard) {
+        auto& stream = *data_stream;
+        auto& session = *reinterpret_cast<http::server::session*>(user_data);
+
+        stream.received += len;
+
+        if (stream.request.discard) {
             TIMBER_DEBUG(
                 "Stream ID {} discarded data chunk of {:L} bytes",
                 stream_id,
                 len
             );
 
+            session.consume(stream, len);
             return 0;
         }
 
@@ -131,31 +218,20 @@ namespace {
             len
         );
 
-        request.data = std::span<const std::byte>(
-            reinterpret_cast<const std::byte*>(data),
-            len
-        );
-
-        if (request.continuation) {
-            request.continuation.resume();
-            if (request.discard || request.continuation) return 0;
-        }
+        const auto* const bytes = reinterpret_cast<const std::byte*>(data);
+        stream.inbox.insert(stream.inbox.end(), bytes, bytes + len);
 
-        TIMBER_DEBUG("Stream ID {} attempting to pause data recv", stream_id);
+        session.refresh_timeout(stream);
 
-        auto& session = *reinterpret_cast<http::server::session*>(user_data);
-        session.pause = &request.continuation;
-
-        return NGHTTP2_ERR_PAUSE;
+        session.deliver(stream);
+        return 0;
     }
 
     auto on_header_callback(
         nghttp2_session* handle,
         const nghttp2_frame* frame,
-        const std::uint8_t* name,
-        std::size_t namelen,
-        const std::uint8_t* value,
-        std::size_t valuelen,
+        nghttp2_rcbuf* name,
+        nghttp2_rcbuf* value,
         std::uint8_t flags,
         void* user_data
     ) -> int {
@@ -168,17 +244,11 @@ namespace {
                             handle,
                             frame->hd.stream_id
                         )
-                    ))
-                    stream->recv_header(
-                        std::string_view(
-                            reinterpret_cast<const char*>(name),
-                            namelen
-                        ),
-                        std::string_view(
-                            reinterpret_cast<const char*>(value),
-                            valuelen
-                        )
-                    );
+                    )) {
+                    auto& session =
+                        *reinterpret_cast<http::server::session*>(user_data);
+                    session.recv_header(*stream, name, value);
+                }
                 break;
             }
         }
@@ -207,15 +277,16 @@ namespace {
                     stream.request.eof = true;
                 }
 
-                session.handle_request(stream);
+                session.refresh_timeout(stream);
+                session.dispatch(stream);
                 break;
             case NGHTTP2_DATA:
                 TIMBER_DEBUG("Stream ID {} data frame complete", stream.id);
 
                 if (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) {
-                    stream.request.data = std::span<const std::byte>();
-                    stream.request.eof = true;
-                    stream.request.continuation.resume();
+                    stream.ended = true;
+                    session.refresh_timeout(stream);
+                    session.deliver(stream);
                 }
                 break;
         }
@@ -253,8 +324,9 @@ namespace {
         if (auto* stream = reinterpret_cast<http::server::stream*>(
                 nghttp2_session_get_stream_user_data(handle, stream_id)
             )) {
-            if (stream->active) stream->open = false;
-            else delete stream;
+            auto& session =
+                *reinterpret_cast<http::server::session*>(user_data);
+            session.close_stream(*stream);
         }
 
         return 0;
@@ -262,13 +334,74 @@ namespace {
 }
 
 namespace http::server {
+    auto detail::change_priority(
+        nghttp2_session* session,
+        const http2_settings& settings,
+        std::int32_t stream_id,
+        const priority& priority
+    ) -> int {
+        // nghttp2 ignores the change without an error unless RFC 9218
+        // priorities were enabled in the SETTINGS sent to the client.
+        if (settings.no_rfc7540_priorities != 1u) {
+            return NGHTTP2_ERR_INVALID_STATE;
+        }
+
+        const auto extpri = nghttp2_extpri {
+            .urgency = priority.urgency,
+            .inc = priority.incremental ? 1 : 0};
+
+        return nghttp2_session_change_extpri_stream_priority(
+            session,
+            stream_id,
+            &extpri,
+            1
+        );
+    }
+
+    auto detail::settings(const http2_settings& values)
+        -> std::vector<nghttp2_settings_entry> {
+        auto result = std::vector<nghttp2_settings_entry>();
+
+        const auto add = [&](std::int32_t id, auto value) {
+            if (value) result.push_back({id, *value});
+        };
+
+        add(NGHTTP2_SETTINGS_HEADER_TABLE_SIZE, values.header_table_size);
+        add(
+            NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS,
+            values.max_concurrent_streams
+        );
+        add(NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, values.initial_window_size);
+        add(NGHTTP2_SETTINGS_MAX_FRAME_SIZE, values.max_frame_size);
+        add(NGHTTP2_SETTINGS_MAX_HEADER_LIST_SIZE, values.max_header_list_size);
+        add(
+            NGHTTP2_SETTINGS_NO_RFC7540_PRIORITIES,
+            values.no_rfc7540_priorities
+        );
+
+        return result;
+    }
+
     session::session(
-        netcore::ssl::socket&& socket,
-        std::size_t buffer_size,
-        server::router& router
+        server::socket&& socket,
+        const server::options& options,
+        const nghttp2_option* option,
+        server::router& router,
+        server::counters& counters,
+        concurrency_limit* admission
     ) :
-        socket(std::forward<netcore::ssl::socket>(socket), buffer_size),
-        router(&router) {
+        socket(std::forward<server::socket>(socket)),
+        http2(options.http2),
+        batching(options.send),
+        limits(options.limits),
+        timeouts(options.timeouts),
+        router(&router),
+        counters(&counters),
+        admission(admission),
+        idle_timeout([this] {
+            TIMBER_DEBUG("{} idle timeout", *this);
+            if (!draining) goaway();
+        }) {
         nghttp2_session_callbacks* callbacks = nullptr;
         nghttp2_session_callbacks_new(&callbacks);
 
@@ -287,7 +420,7 @@ namespace http::server {
             on_frame_recv_callback
         );
 
-        nghttp2_session_callbacks_set_on_header_callback(
+        nghttp2_session_callbacks_set_on_header_callback2(
             callbacks,
             on_header_callback
         );
@@ -302,7 +435,12 @@ namespace http::server {
             on_stream_close
         );
 
-        nghttp2_session_server_new(&handle, callbacks, this);
+        nghttp2_session_callbacks_set_send_data_callback(
+            callbacks,
+            send_data_callback
+        );
+
+        nghttp2_session_server_new2(&handle, callbacks, this, option);
         nghttp2_session_callbacks_del(callbacks);
 
         TIMBER_TRACE("{} created for {}", *this, this->socket);
@@ -311,6 +449,8 @@ namespace http::server {
     session::~session() {
         unlink();
         streams.delete_all();
+        retired.delete_all();
+        pool.delete_all();
         nghttp2_session_del(handle);
 
         if (handle) { TIMBER_TRACE("{} destroyed", *this); }
@@ -322,14 +462,19 @@ namespace http::server {
         try {
             co_await closed;
             TIMBER_TRACE("{} close requested", *this);
-            co_return;
         }
         catch (...) {
             exception = std::current_exception();
         }
 
+        // The send loop may have requested the close; let it return before
+        // the session is torn down.
         co_await netcore::yield();
-        std::rethrow_exception(exception);
+        if (exception) std::rethrow_exception(exception);
+    }
+
+    auto session::can_sendfile() const noexcept -> bool {
+        return socket.can_sendfile();
     }
 
     auto session::close() noexcept -> void {
@@ -345,8 +490,109 @@ namespace http::server {
         } while (current != this);
     }
 
+    auto session::close_stream(stream& stream) noexcept -> void {
+        stream.read_timeout.cancel();
+
+        if (stream.active) {
+            stream.open = false;
+
+            auto& data = stream.response.data;
+
+            if (auto* body = std::get_if<streaming_body>(&data)) {
+                body->writer->abort();
+            }
+
+            return;
+        }
+
+        // Frames referencing the stream's response may still be queued
+        // for writing; defer its reuse until the next flush.
+        retired.link(stream);
+
+        if (streams.empty()) idle_timeout.arm(timeouts.idle);
+    }
+
+    auto session::consume(stream& stream, std::size_t length) -> void {
+        if (length == 0) return;
+
+        // A rejected body gets no more stream window, so the peer cannot
+        // keep sending it.
+        if (!stream.rejected) {
+            nghttp2_session_consume_stream(handle, stream.id, length);
+        }
+
+        refresh_timeout(stream);
+
+        if (send) send();
+    }
+
+    auto session::deliver(stream& stream) -> void {
+        if (!stream.pumping) pump(stream);
+    }
+
+    auto session::discard_body(stream& stream) -> void {
+        stream.request.discard = true;
+
+        // Wake the pump so that it returns any unread data to the window.
+        if (stream.pumping && stream.request.continuation) {
+            stream.request.continuation.resume();
+        }
+    }
+
+    auto session::dispatch(stream& stream) -> void {
+        // Shed load before a handler or any of the body costs anything.
+        if (auto permit = admit(admission)) {
+            handle_request(stream, std::move(*permit));
+        }
+        else refuse(stream);
+    }
+
+    auto session::drain() noexcept -> void {
+        auto* current = this;
+
+        do {
+            auto* const next = current->next;
+
+            if (current->handle && !current->draining) current->goaway();
+
+            current = next;
+        } while (current != this);
+    }
+
+    auto session::drain(body_writer& writer) -> void {
+        drained.push_back(&writer);
+    }
+
+    auto session::goaway() -> void {
+        draining = true;
+
+        const auto rv = nghttp2_submit_goaway(
+            handle,
+            NGHTTP2_FLAG_NONE,
+            nghttp2_session_get_last_proc_stream_id(handle),
+            NGHTTP2_NO_ERROR,
+            nullptr,
+            0
+        );
+
+        if (rv != 0) {
+            TIMBER_ERROR(
+                "{} failed to submit GOAWAY: {}",
+                *this,
+                nghttp2_strerror(rv)
+            );
+            closed.resume();
+            return;
+        }
+
+        TIMBER_DEBUG("{} draining", *this);
+
+        if (send) send();
+    }
+
     auto session::handle_connection() -> ext::task<> {
         send_server_connection_header();
+        idle_timeout.arm(timeouts.header);
 
         try {
             co_await recv();
@@ -375,14 +621,44 @@ namespace http::server {
         co_await tasks.await();
     }
 
-    auto session::handle_request(stream& stream) -> ext::detached_task {
+    auto session::handle_request(
+        stream& stream,
+        concurrency_limit::permit permit
+    ) -> pooled_detached_task {
         const auto counter = tasks.increment();
         stream.active = true;
+        counters->request();
 
         TIMBER_DEBUG("{}", stream);
 
+        stream.handler_timeout.arm(timeouts.handler);
+        stream.request.max_body_size = limits.max_body_size;
+
         try {
-            if (co_await router->route(stream)) co_await respond(stream);
+            auto routed = true;
+
+            if (oversized(stream)) {
+                stream.response.status = 431;
+                stream.response.send("Request header fields too large"sv);
+            }
+            else routed = co_await router->route(stream);
+
+            stream.handler_timeout.cancel();
+            permit.release(stream.request.waiting);
+
+            const auto status = stream.response.status;
+            if (status == 413 || status == 503) stream.rejected = true;
+
+            discard_body(stream);
+
+            if (routed) {
+                co_await respond(stream);
+
+                auto& data = stream.response.data;
+                auto* const body = std::get_if<streaming_body>(&data);
+
+                if (body && stream.open) co_await produce(stream, *body);
+            }
         }
         catch (const std::exception& ex) {
             TIMBER_ERROR("Session handler failed: {}", ex.what());
@@ -391,8 +667,10 @@ namespace http::server {
             TIMBER_ERROR("Session handler failed");
         }
 
+        stream.handler_timeout.cancel();
         stream.active = false;
-        if (!stream.open) delete &stream;
+
+        if (!stream.open) close_stream(stream);
     }
 
     auto session::idle() const noexcept -> bool { return streams.empty(); }
@@ -406,13 +684,138 @@ namespace http::server {
     }
 
     auto session::make_stream(std::int32_t id) -> stream& {
-        auto* stream = new server::stream(id);
+        auto* stream = pool.pop();
+
+        if (stream) {
+            --pooled;
+            stream->id = id;
+            TIMBER_TRACE("Stream ID {} opened", id);
+        }
+        else {
+            stream = new server::stream(id, &memory);
+
+            // Pooled streams stay with this session, so the callbacks only
+            // need to be set once.
+            stream->read_timeout.set_callback([this, stream] {
+                // A handler that has yet to read buffered data is holding
+                // the window shut; the peer is not to blame for the silence.
+                if (!stream->inbox.empty() || stream->unconsumed > 0) {
+                    stream->read_timeout.arm(timeouts.body);
+                }
+                else time_out(*stream);
+            });
+            stream->handler_timeout.set_callback([this, stream] {
+                time_out(*stream);
+            });
+        }
 
         streams.link(*stream);
+        idle_timeout.cancel();
+        stream->read_timeout.arm(timeouts.header);
 
         return *stream;
     }
 
+    auto session::oversized(const stream& stream) const noexcept -> bool {
+        return stream.header_count > limits.max_header_count ||
+               stream.header_size > limits.max_header_list_size;
+    }
+
+    auto session::produce(stream& stream, streaming_body& body)
+        -> ext::task<> {
+        auto& writer = *body.writer;
+
+        try {
+            co_await body.producer(writer);
+            writer.finish();
+        }
+        catch (const stream_aborted&) {
+            TIMBER_DEBUG("Stream ID {} closed while streaming", stream.id);
+        }
+        catch (const std::exception& ex) {
+            TIMBER_ERROR(
+                "Stream ID {} body producer failed: {}",
+                stream.id,
+                ex.what()
+            );
+
+            if (stream.open) {
+                nghttp2_submit_rst_stream(
+                    handle,
+                    NGHTTP2_FLAG_NONE,
+                    stream.id,
+                    NGHTTP2_INTERNAL_ERROR
+                );
+
+                if (send) send();
+            }
+        }
+    }
+
+    auto session::pump(stream& stream) -> pooled_detached_task {
+        const auto counter = tasks.increment();
+        auto& request = stream.request;
+
+        stream.pumping = true;
+
+        try {
+            while (!request.discard) {
+                // Wait for the handler to finish with the data it holds.
+                if (!request.continuation) co_await request.continuation;
+                if (request.discard) break;
+
+                consume(stream, std::exchange(stream.unconsumed, 0));
+
+                if (stream.inbox.empty() && (!stream.ended || request.eof)) {
+                    break;
+                }
+
+                const auto limit = request.max_body_size;
+
+                if (limit && stream.received > *limit) {
+                    stream.rejected = true;
+                    request.discard = true;
+
+                    request.continuation.resume(
+                        std::make_exception_ptr(error_code(
+                            413,
+                            "Request body exceeds {:L} bytes",
+                            *limit
+                        ))
+                    );
+
+                    break;
+                }
+
+                std::swap(stream.held, stream.inbox);
+                stream.inbox.clear();
+
+                request.data = stream.held;
+                stream.unconsumed = stream.held.size();
+
+                if (stream.ended) {
+                    // The peer cannot send anything more on this stream.
+                    request.eof = true;
+                    consume(stream, std::exchange(stream.unconsumed, 0));
+                }
+
+                request.continuation.resume();
+            }
+        }
+        catch (const stream_aborted&) {}
+
+        if (request.discard) {
+            consume(
+                stream,
+                std::exchange(stream.unconsumed, 0) + stream.inbox.size()
+            );
+
+            stream.inbox.clear();
+        }
+
+        stream.pumping = false;
+    }
+
     auto session::recv() -> ext::task<> {
         auto bytes = std::span<const std::byte>();
 
@@ -439,25 +842,117 @@ namespace http::server {
             // nghttp2_session_mem_recv() to ensure that we don't miss
             // sending any pending WINDOW_UPDATE frames.
             co_await send;
-
-            if (pause) co_await *std::exchange(pause, nullptr);
         } while (!bytes.empty());
     }
 
-    auto session::respond(stream& stream) -> ext::task<> {
-        if (pause && pause->awaiting()) {
-            stream.request.discard = true;
-            co_await *pause;
+    auto session::recycle_retired() noexcept -> void {
+        const auto limit = http2.settings.max_concurrent_streams.value_or(100);
+
+        while (auto* const stream = retired.pop()) {
+            if (pooled == limit) {
+                delete stream;
+                continue;
+            }
+
+            stream->clear();
+            pool.link(*stream);
+            ++pooled;
         }
+    }
+
+    auto session::recv_header(
+        stream& stream,
+        nghttp2_rcbuf* name,
+        nghttp2_rcbuf* value
+    ) -> void {
+        const auto size = nghttp2_rcbuf_get_buf(name).len +
+                          nghttp2_rcbuf_get_buf(value).len + 32;
+
+        ++stream.header_count;
+        stream.header_size += size;
+
+        // Once over the limits, nothing more is kept: the request is
+        // answered with 431 without being routed.
+        if (!oversized(stream)) stream.recv_header(name, value);
+    }
+
+    auto session::refuse(stream& stream) -> void {
+        TIMBER_DEBUG("Stream ID {} refused: server at capacity", stream.id);
+
+        counters->refuse();
+        stream.request.discard = true;
 
+        nghttp2_submit_rst_stream(
+            handle,
+            NGHTTP2_FLAG_NONE,
+            stream.id,
+            NGHTTP2_REFUSED_STREAM
+        );
+
+        if (send) send();
+    }
+
+    auto session::refresh_timeout(stream& stream) -> void {
+        if (stream.ended || stream.request.eof || !stream.open) {
+            stream.read_timeout.cancel();
+        }
+        else stream.read_timeout.arm(timeouts.body);
+    }
+
+    auto session::resume_producers() -> bool {
+        if (drained.empty()) return false;
+
+        // Producers may drain again while they are resumed.
+        std::swap(drained, resuming);
+
+        for (auto* const writer : resuming) writer->resume();
+        resuming.clear();
+
+        return true;
+    }
+
+    auto session::respond(stream& stream) -> pooled_task<> {
         auto& res = stream.response;
-        auto headers = std::vector<nghttp2_nv>();
 
-        const auto status = fmt::to_string(res.status);
-        headers.push_back(make_nv(":status", status));
+        // Names are either static or lowercase copies owned by the response,
+        // and values live in the response until the stream is recycled, so
+        // nghttp2 can reference all of them in place.
+        constexpr auto no_copy =
+            NGHTTP2_NV_FLAG_NO_COPY_NAME | NGHTTP2_NV_FLAG_NO_COPY_VALUE;
+
+        nva.clear();
+        nva.push_back(make_nv(":status", status_string(res.status), no_copy));
 
-        for (const auto& [name, value] : res.headers) {
-            headers.push_back(make_nv(name, value));
+        for (const auto& field : res.headers) {
+            nva.push_back(make_nv(field.name, field.value, no_copy));
+        }
+
+        if (auto* body = std::get_if<streaming_body>(&res.data)) {
+            body->writer->set_notify([this, &stream, &writer = *body->writer] {
+                if (writer.take_deferred()) {
+                    nghttp2_session_resume_data(handle, stream.id);
+                }
+
+                if (send) send();
+            });
+        }
+
+        if (res.priority) {
+            // The handler knows the response better than the client's
+            // guess from the request did.
+            if (const auto rv = detail::change_priority(
+                    handle,
+                    http2.settings,
+                    stream.id,
+                    *res.priority
+                );
+                rv != 0) {
+                TIMBER_DEBUG(
+                    "Stream ID {} priority ignored: {}",
+                    stream.id,
+                    nghttp2_strerror(rv)
+                );
+            }
         }
 
         auto provider = nghttp2_data_provider {
@@ -470,8 +965,8 @@ namespace http::server {
         const auto rv = nghttp2_submit_response(
             handle,
             stream.id,
-            headers.data(),
-            headers.size(),
+            nva.data(),
+            nva.size(),
             std::holds_alternative<std::monostate>(res.data) ? nullptr
                                                              : &provider
         );
@@ -481,11 +976,9 @@ namespace http::server {
     }
 
     auto session::send_server_connection_header() -> void {
-        auto settings = std::array {nghttp2_settings_entry {
-            NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS,
-            100}};
+        const auto settings = detail::settings(http2.settings);
 
-        const auto rv = nghttp2_submit_settings(
+        auto rv = nghttp2_submit_settings(
             handle,
             NGHTTP2_FLAG_NONE,
             settings.data(),
@@ -494,33 +987,141 @@ namespace http::server {
 
         if (rv != 0) throw std::runtime_error(nghttp2_strerror(rv));
 
+        if (http2.connection_window_size) {
+            rv = nghttp2_session_set_local_window_size(
+                handle,
+                NGHTTP2_FLAG_NONE,
+                0,
+                *http2.connection_window_size
+            );
+
+            if (rv != 0) throw std::runtime_error(nghttp2_strerror(rv));
+        }
+
         send_task = start_send();
     }
 
+    auto session::send_data(
+        const std::uint8_t* header,
+        const void* data,
+        std::size_t length
+    ) -> void {
+        batch.append(header, 9);
+        batch.reference(data, length);
+    }
+
+    auto session::send_file(
+        const std::uint8_t* header,
+        const file& file,
+        std::size_t offset,
+        std::size_t length
+    ) -> void {
+        auto& frame = pending_file.emplace(file_frame {
+            .fd = file.descriptor(),
+            .offset = file.offset + offset,
+            .length = length});
+
+        std::copy_n(header, frame.header.size(), frame.header.begin());
+    }
+
+    auto session::flush_batch() -> ext::task<> {
+        if (batch.empty()) co_return;
+
+        co_await socket.write(batch.iov());
+        batch.clear();
+    }
+
     auto session::start_send() -> ext::jtask<> {
         while (true) {
+            // Let other streams that became ready during this turn of the
+            // event loop submit their frames so they share the batch.
+            for (auto i = 0u; i < batching.coalesce_turns; ++i) {
+                co_await netcore::yield();
+            }
+
             const std::uint8_t* src = nullptr;
 
-            while (const auto length = nghttp2_session_mem_send(handle, &src)) {
-                if (length < 0) {
-                    closed.resume(std::make_exception_ptr(
-                        std::runtime_error(nghttp2_strerror(length))
-                    ));
+            socket.cork();
+
+            while (true) {
+                while (const auto length =
+                           nghttp2_session_mem_send(handle, &src)) {
+                    if (length < 0) {
+                        socket.uncork();
+
+                        closed.resume(std::make_exception_ptr(
+                            std::runtime_error(nghttp2_strerror(length))
+                        ));
 
-                    co_return;
+                        co_return;
+                    }
+
+                    // The buffer returned by nghttp2_session_mem_send() is
+                    // only valid until the next call.
+                    if (static_cast<std::size_t>(length) >= max_copy) {
+                        batch.reference(src, length);
+                        co_await flush_batch();
+                        continue;
+                    }
+
+                    batch.append(src, length);
+
+                    if (batch.size() >= batching.max_batch) {
+                        co_await flush_batch();
+                    }
                 }
 
-                co_await socket.write(src, length);
+                if (!pending_file) break;
+
+                const auto frame = *std::exchange(pending_file, std::nullopt);
+
+                batch.append(frame.header.data(), frame.header.size());
+                co_await flush_batch();
+                co_await socket.sendfile(frame.fd, frame.offset, frame.length);
             }
 
-            co_await socket.flush();
+            co_await flush_batch();
+            socket.uncork();
+
+            // Producers are resumed only once their chunks have been written,
+            // so that the frames referencing them stay valid until then.
+            if (resume_producers()) continue;
+
+            recycle_retired();
 
             TIMBER_TRACE("{} send complete", *this);
 
+            if (draining && !nghttp2_session_want_read(handle) &&
+                !nghttp2_session_want_write(handle)) {
+                TIMBER_DEBUG("{} drained", *this);
+                closed.resume();
+                co_return;
+            }
+
             co_await send;
         }
     }
 
+    auto session::time_out(stream& stream) -> void {
+        TIMBER_DEBUG("Stream ID {} timed out", stream.id);
+
+        stream.read_timeout.cancel();
+        stream.handler_timeout.cancel();
+
+        nghttp2_submit_rst_stream(
+            handle,
+            NGHTTP2_FLAG_NONE,
+            stream.id,
+            NGHTTP2_CANCEL
+        );
+
+        // Wake anything waiting on the stream so that it can be reclaimed
+        // as soon as the handler lets go of it.
+        stream.abort();
+
+        if (send) send();
+    }
+
     auto session::unlink() noexcept -> void {
         next->prev = prev;
         prev->next = next;
@@ -0,0 +1,178 @@
+#include <http/server/session.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace std::literals;
+
+using http::server::detail::change_priority;
+
+namespace {
+    class PriorityTest : public testing::Test {
+    protected:
+        nghttp2_session* client = nullptr;
+        nghttp2_session* server = nullptr;
+        std::vector<std::int32_t> data;
+
+        static auto make_nv(std::string_view name, std::string_view value)
+            -> nghttp2_nv {
+            return {
+                .name = (std::uint8_t*) name.data(),
+                .value = (std::uint8_t*) value.data(),
+                .namelen = name.size(),
+                .valuelen = value.size(),
+                .flags = NGHTTP2_NV_FLAG_NONE};
+        }
+
+        static auto transfer(nghttp2_session* from, nghttp2_session* to)
+            -> void {
+            const std::uint8_t* bytes = nullptr;
+
+            while (const auto length = nghttp2_session_mem_send(from, &bytes)) {
+                ASSERT_GT(length, 0);
+                ASSERT_EQ(length, nghttp2_session_mem_recv(to, bytes, length));
+            }
+        }
+
+        PriorityTest() {
+            auto* callbacks = static_cast<nghttp2_session_callbacks*>(nullptr);
+            nghttp2_session_callbacks_new(&callbacks);
+
+            nghttp2_session_client_new(&client, callbacks, nullptr);
+
+            // DATA frames leave the server in priority order.
+            nghttp2_session_callbacks_set_on_frame_send_callback(
+                callbacks,
+                [](nghttp2_session*, const nghttp2_frame* frame, void* data) {
+                    if (frame->hd.type == NGHTTP2_DATA) {
+                        static_cast<std::vector<std::int32_t>*>(data)
+                            ->push_back(frame->hd.stream_id);
+                    }
+
+                    return 0;
+                }
+            );
+
+            nghttp2_session_server_new(&server, callbacks, &data);
+
+            nghttp2_session_callbacks_del(callbacks);
+        }
+
+        ~PriorityTest() {
+            nghttp2_session_del(client);
+            nghttp2_session_del(server);
+        }
+
+        auto connect(const http::server::http2_settings& values) -> void {
+            const auto settings = http::server::detail::settings(values);
+            const auto client_settings = std::array {nghttp2_settings_entry {
+                NGHTTP2_SETTINGS_NO_RFC7540_PRIORITIES,
+                1}};
+
+            nghttp2_submit_settings(
+                server,
+                NGHTTP2_FLAG_NONE,
+                settings.data(),
+                settings.size()
+            );
+            nghttp2_submit_settings(
+                client,
+                NGHTTP2_FLAG_NONE,
+                client_settings.data(),
+                client_settings.size()
+            );
+
+            transfer(server, client);
+            transfer(client, server);
+            transfer(server, client);
+        }
+
+        auto request(std::string_view priority) -> std::int32_t {
+            const auto nva = std::array {
+                make_nv(":method", "GET"),
+                make_nv(":scheme", "https"),
+                make_nv(":authority", "example.com"),
+                make_nv(":path", "/"),
+                make_nv("priority", priority),
+            };
+
+            const auto id = nghttp2_submit_request(
+                client,
+                nullptr,
+                nva.data(),
+                nva.size(),
+                nullptr,
+                nullptr
+            );
+
+            transfer(client, server);
+            return id;
+        }
+
+        auto respond(std::initializer_list<std::int32_t> ids)
+            -> std::vector<std::int32_t> {
+            const auto nva = std::array {make_nv(":status", "200")};
+            const auto provider = nghttp2_data_provider {
+                .read_callback = [](nghttp2_session*,
+                                    std::int32_t,
+                                    std::uint8_t* buffer,
+                                    std::size_t,
+                                    std::uint32_t* flags,
+                                    nghttp2_data_source*,
+                                    void*) -> ssize_t {
+                    buffer[0] = 'x';
+                    *flags |= NGHTTP2_DATA_FLAG_EOF;
+                    return 1;
+                }};
+
+            for (const auto id : ids) {
+                nghttp2_submit_response(
+                    server,
+                    id,
+                    nva.data(),
+                    nva.size(),
+                    &provider
+                );
+            }
+
+            data.clear();
+            transfer(server, client);
+
+            return data;
+        }
+    };
+}
+
+TEST_F(PriorityTest, Header) {
+    connect({});
+
+    const auto low = request("u=7");
+    const auto high = request("u=0, i");
+
+    EXPECT_EQ(std::vector({high, low}), respond({low, high}));
+}
+
+TEST_F(PriorityTest, Handler) {
+    const auto settings = http::server::http2_settings();
+    connect(settings);
+
+    const auto first = request("u=0");
+    const auto second = request("u=7");
+
+    EXPECT_EQ(0, change_priority(server, settings, first, {.urgency = 7}));
+    EXPECT_EQ(0, change_priority(server, settings, second, {.urgency = 0}));
+
+    EXPECT_EQ(std::vector({second, first}), respond({first, second}));
+}
+
+TEST_F(PriorityTest, Disabled) {
+    const auto settings =
+        http::server::http2_settings {.no_rfc7540_priorities = std::nullopt};
+    connect(settings);
+
+    const auto id = request("u=7");
+
+    EXPECT_EQ(
+        NGHTTP2_ERR_INVALID_STATE,
+        change_priority(server, settings, id, {.urgency = 0})
+    );
+}
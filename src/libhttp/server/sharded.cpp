@@ -0,0 +1,349 @@
+#include <http/server/server.hpp>
+#include <http/server/sharded.hpp>
+
+#include <cstring>
+#include <netdb.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    auto system_error(std::string_view message) -> std::system_error {
+        return std::system_error(
+            errno,
+            std::generic_category(),
+            std::string(message)
+        );
+    }
+
+    auto allowed_cpus() -> std::vector<int> {
+        auto set = cpu_set_t();
+        CPU_ZERO(&set);
+
+        auto cpus = std::vector<int>();
+
+        if (sched_getaffinity(0, sizeof(set), &set) == -1) {
+            TIMBER_WARNING(
+                "Failed to read CPU affinity: {}",
+                std::strerror(errno)
+            );
+        }
+        else {
+            for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+
+        if (cpus.empty()) {
+            const auto count =
+                std::max(std::thread::hardware_concurrency(), 1u);
+            for (auto cpu = 0u; cpu < count; ++cpu) cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
+
+    auto listen(
+        const sockaddr* address,
+        socklen_t length,
+        int backlog
+    ) -> netcore::fd {
+        auto fd = netcore::fd(::socket(
+            address->sa_family,
+            SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            0
+        ));
+
+        if (!fd.valid()) throw system_error("Failed to create socket");
+
+        const int enable = 1;
+
+        for (const auto option : {SO_REUSEADDR, SO_REUSEPORT}) {
+            const auto ret =
+                setsockopt(fd, SOL_SOCKET, option, &enable, sizeof(enable));
+
+            if (ret == -1) {
+                throw system_error("Failed to set listener socket option");
+            }
+        }
+
+        if (::bind(fd, address, length) == -1) {
+            throw system_error("Failed to bind listener");
+        }
+
+        if (::listen(fd, backlog) == -1) {
+            throw system_error("Failed to listen for connections");
+        }
+
+        return fd;
+    }
+
+    auto pin(int cpu) noexcept -> void {
+        auto set = cpu_set_t();
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+
+        const auto ret =
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+        if (ret != 0) {
+            TIMBER_WARNING(
+                "Failed to pin shard to CPU {}: {}",
+                cpu,
+                std::strerror(ret)
+            );
+        }
+    }
+}
+
+namespace http::server {
+    struct sharded_server::shard {
+        const std::size_t index;
+        netcore::fd listener;
+        netcore::fd wakeup;
+        http::server::context context;
+        const netcore::ssl::context* ssl;
+        ext::counter connections;
+        std::thread thread;
+
+        shard(
+            std::size_t index,
+            netcore::fd&& listener,
+            http::server::router& router,
+            const http::server::options& options,
+            std::shared_ptr<concurrency_limit> admission,
+            const netcore::ssl::context* ssl
+        ) :
+            index(index),
+            listener(std::forward<netcore::fd>(listener)),
+            wakeup(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+            context(router, options, std::move(admission)),
+            ssl(ssl) {
+            if (!wakeup.valid()) throw system_error("Failed to create eventfd");
+        }
+
+        auto accept() -> void {
+            while (true) {
+                auto client = netcore::fd(::accept4(
+                    listener,
+                    nullptr,
+                    nullptr,
+                    SOCK_NONBLOCK | SOCK_CLOEXEC
+                ));
+
+                if (client.valid()) {
+                    connection(std::move(client));
+                    continue;
+                }
+
+                switch (errno) {
+                    case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+                    case EWOULDBLOCK:
+#endif
+                        return;
+                    case EINTR:
+                    case ECONNABORTED:
+                    case EPROTO: continue;
+                    default:
+                        TIMBER_ERROR(
+                            "Shard {} failed to accept connection: {}",
+                            index,
+                            std::strerror(errno)
+                        );
+                        return;
+                }
+            }
+        }
+
+        auto connection(netcore::fd&& client) -> ext::detached_task {
+            const auto counter = connections.increment();
+
+            try {
+                auto socket = netcore::socket(std::move(client));
+
+                if (ssl) {
+                    co_await context.connection(
+                        netcore::ssl::socket(*ssl, std::move(socket))
+                    );
+                }
+                else co_await context.connection(std::move(socket));
+            }
+            catch (const std::exception& ex) {
+                TIMBER_DEBUG(
+                    "Shard {} connection failed: {}",
+                    index,
+                    ex.what()
+                );
+            }
+        }
+
+        auto serve() -> ext::task<> {
+            auto incoming = netcore::runtime::event::create(listener, EPOLLIN);
+            auto stop = netcore::runtime::event::create(wakeup, EPOLLIN);
+
+            TIMBER_DEBUG("Shard {} accepting connections", index);
+
+            while (true) {
+                accept();
+
+                auto result = co_await ext::race(incoming->in(), stop->in());
+                if (result.index() == 1) break;
+
+                co_await std::get<0>(std::move(result));
+            }
+
+            TIMBER_DEBUG("Shard {} shutting down", index);
+
+            // Stop the kernel from queueing connections to this shard.
+            incoming->remove();
+            listener = netcore::fd();
+
+            context.shutdown();
+
+            co_await connections.await();
+        }
+
+        auto start(std::optional<int> cpu) -> void {
+            thread = std::thread([this, cpu] {
+                if (cpu) pin(*cpu);
+
+                try {
+                    netcore::run(serve());
+                }
+                catch (const std::exception& ex) {
+                    TIMBER_ERROR("Shard {} failed: {}", index, ex.what());
+                }
+            });
+        }
+    };
+
+    sharded_server::sharded_server(
+        http::server::router& router,
+        const http::server::options& options,
+        const http::server::shard_options& shard_options,
+        const netcore::ssl::context* ssl
+    ) {
+        const auto cpus = allowed_cpus();
+        const auto count =
+            shard_options.shards == 0 ? cpus.size() : shard_options.shards;
+
+        const auto hints = addrinfo {
+            .ai_flags = AI_PASSIVE,
+            .ai_family = AF_UNSPEC,
+            .ai_socktype = SOCK_STREAM};
+
+        addrinfo* info = nullptr;
+        const auto port = std::to_string(shard_options.port);
+
+        if (const auto ret = getaddrinfo(
+                shard_options.host.c_str(),
+                port.c_str(),
+                &hints,
+                &info
+            );
+            ret != 0) {
+            throw std::runtime_error(fmt::format(
+                "Failed to resolve '{}': {}",
+                shard_options.host,
+                gai_strerror(ret)
+            ));
+        }
+
+        const auto deleter =
+            std::unique_ptr<addrinfo, decltype(&freeaddrinfo)>(
+                info,
+                freeaddrinfo
+            );
+
+        // Every shard binds its own listener to the same address so that the
+        // kernel balances incoming connections across them. When an
+        // ephemeral port is requested, the rest follow the first shard's.
+        auto address = sockaddr_storage();
+        auto length = static_cast<socklen_t>(info->ai_addrlen);
+        std::memcpy(&address, info->ai_addr, length);
+
+        shards.reserve(count);
+
+        // One limit for the whole server rather than one per shard.
+        const auto admission =
+            options.admission
+                ? std::make_shared<concurrency_limit>(*options.admission)
+                : nullptr;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            auto* const addr = reinterpret_cast<sockaddr*>(&address);
+            auto listener = listen(addr, length, shard_options.backlog);
+
+            if (i == 0 && getsockname(listener, addr, &length) == -1) {
+                throw system_error("Failed to read listener address");
+            }
+
+            shards.push_back(std::make_unique<shard>(
+                i,
+                std::move(listener),
+                router,
+                options,
+                admission,
+                ssl
+            ));
+        }
+
+        for (auto& shard : shards) {
+            auto cpu = std::optional<int>();
+            if (shard_options.pin) cpu = cpus[shard->index % cpus.size()];
+
+            shard->start(cpu);
+        }
+
+        TIMBER_INFO(
+            "Listening on {}:{} with {} shard{}",
+            shard_options.host,
+            shard_options.port,
+            count,
+            count == 1 ? "" : "s"
+        );
+    }
+
+    sharded_server::~sharded_server() {
+        shutdown();
+        wait();
+    }
+
+    auto sharded_server::metrics() const noexcept -> http::server::metrics {
+        auto result = http::server::metrics();
+
+        for (const auto& shard : shards) result += shard->context.metrics();
+
+        return result;
+    }
+
+    auto sharded_server::shutdown() noexcept -> void {
+        TIMBER_DEBUG("Sharded server shutdown requested");
+
+        for (const auto& shard : shards) {
+            const std::uint64_t value = 1;
+
+            if (::write(shard->wakeup, &value, sizeof(value)) == -1) {
+                TIMBER_ERROR(
+                    "Failed to signal shard {}: {}",
+                    shard->index,
+                    std::strerror(errno)
+                );
+            }
+        }
+    }
+
+    auto sharded_server::size() const noexcept -> std::size_t {
+        return shards.size();
+    }
+
+    auto sharded_server::wait() -> void {
+        for (auto& shard : shards) {
+            if (shard->thread.joinable()) shard->thread.join();
+        }
+    }
+}
@@ -0,0 +1,247 @@
+#include <http/server/socket.hpp>
+
+#include <climits>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <sys/sendfile.h>
+
+namespace {
+    auto ktls_send(SSL* ssl) noexcept -> bool {
+#ifdef OPENSSL_NO_KTLS
+        return false;
+#else
+        return BIO_get_ktls_send(SSL_get_wbio(ssl));
+#endif
+    }
+
+    auto ssl_sendfile(
+        netcore::ssl::socket& socket,
+        int fd,
+        std::size_t offset,
+        std::size_t count
+    ) -> ext::task<> {
+        auto* const ssl = socket.native_handle();
+
+        while (count > 0) {
+            const auto ret = SSL_sendfile(ssl, fd, offset, count, 0);
+
+            if (ret > 0) {
+                offset += ret;
+                count -= ret;
+                continue;
+            }
+
+            switch (SSL_get_error(ssl, ret)) {
+                case SSL_ERROR_WANT_WRITE:
+                    co_await socket.wait_for_write();
+                    break;
+                case SSL_ERROR_SYSCALL:
+                    throw std::system_error(
+                        errno,
+                        std::generic_category(),
+                        "SSL_sendfile failure"
+                    );
+                default:
+                    throw std::runtime_error(fmt::format(
+                        "SSL_sendfile failure: {}",
+                        ERR_error_string(ERR_get_error(), nullptr)
+                    ));
+            }
+        }
+    }
+
+    auto tcp_sendfile(
+        netcore::socket& socket,
+        int fd,
+        std::size_t offset,
+        std::size_t count
+    ) -> ext::task<> {
+        auto off = static_cast<off_t>(offset);
+
+        while (count > 0) {
+            const auto ret = ::sendfile(socket.fd(), fd, &off, count);
+
+            if (ret == -1) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    co_await socket.wait_for_write();
+                    continue;
+                }
+
+                if (errno == EINTR) continue;
+
+                throw std::system_error(
+                    errno,
+                    std::generic_category(),
+                    "sendfile failure"
+                );
+            }
+
+            if (ret == 0) throw netcore::eof();
+
+            count -= ret;
+        }
+    }
+}
+
+namespace http::server {
+    socket::socket(netcore::socket&& socket, std::size_t buffer_size) :
+        inner(
+            std::in_place_type<netcore::buffered_socket>,
+            std::forward<netcore::socket>(socket),
+            buffer_size
+        ) {}
+
+    socket::socket(netcore::ssl::socket&& socket, std::size_t buffer_size) :
+        inner(
+            std::in_place_type<netcore::ssl::buffered_socket>,
+            std::forward<netcore::ssl::socket>(socket),
+            buffer_size
+        ) {
+        auto& tls = std::get<netcore::ssl::buffered_socket>(inner);
+        ktls = ktls_send(tls.inner().native_handle());
+
+        if (ktls) { TIMBER_DEBUG("{} using kernel TLS for sends", *this); }
+    }
+
+    auto socket::can_sendfile() const noexcept -> bool {
+        return ktls || !encrypted();
+    }
+
+    auto socket::cork() noexcept -> void {
+        if (!corked) set_cork(true);
+    }
+
+    auto socket::encrypted() const noexcept -> bool {
+        return std::holds_alternative<netcore::ssl::buffered_socket>(inner);
+    }
+
+    auto socket::fd() const noexcept -> int {
+        return std::visit(
+            [](const auto& socket) { return socket.inner().fd(); },
+            inner
+        );
+    }
+
+    auto socket::flush() -> ext::task<> {
+        return std::visit([](auto& socket) { return socket.flush(); }, inner);
+    }
+
+    auto socket::read() -> ext::task<std::span<const std::byte>> {
+        return std::visit([](auto& socket) { return socket.read(); }, inner);
+    }
+
+    auto socket::sendfile(int fd, std::size_t offset, std::size_t count)
+        -> ext::task<> {
+        // Anything still buffered must reach the kernel before the file
+        // contents do.
+        co_await flush();
+
+        if (encrypted()) {
+            auto& socket = std::get<netcore::ssl::buffered_socket>(inner);
+            co_await ssl_sendfile(socket.inner(), fd, offset, count);
+        }
+        else {
+            auto& socket = std::get<netcore::buffered_socket>(inner);
+            co_await tcp_sendfile(socket.inner(), fd, offset, count);
+        }
+
+        TIMBER_TRACE("{} sent file contents from fd ({})", *this, fd);
+    }
+
+    auto socket::set_cork(bool enabled) noexcept -> void {
+        const int value = enabled;
+
+        if (setsockopt(
+                fd(),
+                IPPROTO_TCP,
+                TCP_CORK,
+                &value,
+                sizeof(value)
+            ) == -1) {
+            TIMBER_DEBUG(
+                "{} failed to {} socket: {}",
+                *this,
+                enabled ? "cork" : "uncork",
+                std::strerror(errno)
+            );
+            return;
+        }
+
+        corked = enabled;
+    }
+
+    auto socket::shutdown() -> void {
+        std::visit([](auto& socket) { socket.shutdown(); }, inner);
+    }
+
+    auto socket::uncork() noexcept -> void {
+        if (corked) set_cork(false);
+    }
+
+    auto socket::wait_for_write() -> ext::task<> {
+        return std::visit(
+            [](auto& socket) { return socket.inner().wait_for_write(); },
+            inner
+        );
+    }
+
+    auto socket::write(std::span<iovec> iov) -> ext::task<> {
+        if (encrypted() && !ktls) {
+            // Records are encrypted in userspace: gather the batch into the
+            // TLS buffer so that it is sealed into as few records as possible.
+            auto& socket = std::get<netcore::ssl::buffered_socket>(inner);
+
+            for (const auto& vec : iov) {
+                co_await socket.write(vec.iov_base, vec.iov_len);
+            }
+
+            co_await socket.flush();
+            co_return;
+        }
+
+        co_await flush();
+
+        const auto descriptor = fd();
+        auto remaining = iov;
+
+        while (!remaining.empty()) {
+            const auto ret = ::writev(
+                descriptor,
+                remaining.data(),
+                std::min<std::size_t>(remaining.size(), IOV_MAX)
+            );
+
+            if (ret == -1) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    co_await wait_for_write();
+                    continue;
+                }
+
+                if (errno == EINTR) continue;
+
+                throw std::system_error(
+                    errno,
+                    std::generic_category(),
+                    "writev failure"
+                );
+            }
+
+            auto written = static_cast<std::size_t>(ret);
+
+            while (!remaining.empty() && written >= remaining.front().iov_len) {
+                written -= remaining.front().iov_len;
+                remaining = remaining.subspan(1);
+            }
+
+            if (written > 0) {
+                auto& front = remaining.front();
+                front.iov_base =
+                    static_cast<std::byte*>(front.iov_base) + written;
+                front.iov_len -= written;
+            }
+        }
+    }
+}
@@ -3,8 +3,19 @@
 #include <nghttp2/nghttp2.h>
 
 namespace {
-    constexpr auto next_proto_list =
-        std::array<const unsigned char, 3> {2, 'h', '2'};
+    constexpr auto next_proto_list = std::array<const unsigned char, 12> {
+        2,
+        'h',
+        '2',
+        8,
+        'h',
+        't',
+        't',
+        'p',
+        '/',
+        '1',
+        '.',
+        '1'};
 
     auto alpn_select(
         SSL* ssl,
@@ -21,7 +32,8 @@ namespace {
             inlen
         );
 
-        if (ret != 1) return SSL_TLSEXT_ERR_NOACK;
+        // 1 selects h2, 0 falls back to http/1.1.
+        if (ret < 0) return SSL_TLSEXT_ERR_NOACK;
         return SSL_TLSEXT_ERR_OK;
     }
 
@@ -47,4 +59,13 @@ namespace http::server {
 
         return ssl;
     }
+
+    auto enable_ktls(netcore::ssl::context& context) -> bool {
+#ifdef SSL_OP_ENABLE_KTLS
+        SSL_CTX_set_options(context.native_handle(), SSL_OP_ENABLE_KTLS);
+        return true;
+#else
+        return false;
+#endif
+    }
 }
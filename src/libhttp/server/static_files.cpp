@@ -0,0 +1,632 @@
+#include <http/error.h>
+#include <http/server/compression.hpp>
+#include <http/server/response/file.hpp>
+#include <http/server/static_files.hpp>
+
+#include <cstring>
+#include <ext/string.h>
+#include <fcntl.h>
+#include <linux/openat2.h>
+#include <list>
+#include <mutex>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <timber/timber>
+#include <unistd.h>
+
+using namespace std::literals;
+
+namespace {
+    constexpr auto default_media_type = "application/octet-stream"sv;
+
+    // Sorted by extension so that lookups can use a binary search.
+    constexpr auto media_types = std::array {
+        std::pair {"avif"sv, "image/avif"sv},
+        std::pair {"bmp"sv, "image/bmp"sv},
+        std::pair {"css"sv, "text/css; charset=utf-8"sv},
+        std::pair {"csv"sv, "text/csv; charset=utf-8"sv},
+        std::pair {"gif"sv, "image/gif"sv},
+        std::pair {"gz"sv, "application/gzip"sv},
+        std::pair {"htm"sv, "text/html; charset=utf-8"sv},
+        std::pair {"html"sv, "text/html; charset=utf-8"sv},
+        std::pair {"ico"sv, "image/x-icon"sv},
+        std::pair {"jpeg"sv, "image/jpeg"sv},
+        std::pair {"jpg"sv, "image/jpeg"sv},
+        std::pair {"js"sv, "text/javascript; charset=utf-8"sv},
+        std::pair {"json"sv, "application/json"sv},
+        std::pair {"map"sv, "application/json"sv},
+        std::pair {"md"sv, "text/markdown; charset=utf-8"sv},
+        std::pair {"mjs"sv, "text/javascript; charset=utf-8"sv},
+        std::pair {"mp3"sv, "audio/mpeg"sv},
+        std::pair {"mp4"sv, "video/mp4"sv},
+        std::pair {"ogg"sv, "audio/ogg"sv},
+        std::pair {"otf"sv, "font/otf"sv},
+        std::pair {"pdf"sv, "application/pdf"sv},
+        std::pair {"png"sv, "image/png"sv},
+        std::pair {"svg"sv, "image/svg+xml"sv},
+        std::pair {"tar"sv, "application/x-tar"sv},
+        std::pair {"ttf"sv, "font/ttf"sv},
+        std::pair {"txt"sv, "text/plain; charset=utf-8"sv},
+        std::pair {"wasm"sv, "application/wasm"sv},
+        std::pair {"wav"sv, "audio/wav"sv},
+        std::pair {"webm"sv, "video/webm"sv},
+        std::pair {"webmanifest"sv, "application/manifest+json"sv},
+        std::pair {"webp"sv, "image/webp"sv},
+        std::pair {"woff"sv, "font/woff"sv},
+        std::pair {"woff2"sv, "font/woff2"sv},
+        std::pair {"xml"sv, "application/xml"sv},
+        std::pair {"zip"sv, "application/zip"sv},
+    };
+
+    static_assert(std::ranges::is_sorted(media_types));
+
+    constexpr auto codings = std::array {
+        http::server::content_coding::gzip,
+        http::server::content_coding::br,
+        http::server::content_coding::zstd,
+    };
+
+    constexpr auto watch_mask = IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE |
+                                IN_DELETE | IN_MODIFY | IN_MOVED_FROM |
+                                IN_MOVED_TO | IN_ONLYDIR;
+
+    auto system_error(std::string_view message) -> std::system_error {
+        return std::system_error(
+            errno,
+            std::generic_category(),
+            std::string(message)
+        );
+    }
+
+    auto format_date(std::time_t time) -> std::string {
+        auto tm = std::tm();
+        gmtime_r(&time, &tm);
+
+        auto buffer = std::array<char, 32>();
+        const auto size = std::strftime(
+            buffer.data(),
+            buffer.size(),
+            "%a, %d %b %Y %H:%M:%S GMT",
+            &tm
+        );
+
+        return {buffer.data(), size};
+    }
+
+    auto parse_date(std::string_view date) -> std::optional<std::time_t> {
+        auto tm = std::tm();
+        const auto string = std::string(date);
+
+        const auto* const end =
+            strptime(string.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+
+        if (!end || *end != '\0') return std::nullopt;
+
+        return timegm(&tm);
+    }
+
+    auto parent(std::string_view path) -> std::string_view {
+        const auto slash = path.rfind('/');
+        return slash == std::string_view::npos ? ""sv : path.substr(0, slash);
+    }
+
+    auto join(std::string_view directory, std::string_view name)
+        -> std::string {
+        if (directory.empty()) return std::string(name);
+        return fmt::format("{}/{}", directory, name);
+    }
+
+    // Opens a path relative to the root without leaving it or following any
+    // symbolic link on the way, so that a link inside the root cannot expose
+    // files outside of it.
+    auto open_beneath(int root, const std::string& path) -> netcore::fd {
+        auto how = open_how {
+            .flags = O_RDONLY | O_CLOEXEC,
+            .resolve = RESOLVE_BENEATH | RESOLVE_NO_SYMLINKS,
+        };
+
+        const auto fd = static_cast<int>(
+            syscall(SYS_openat2, root, path.c_str(), &how, sizeof(how))
+        );
+
+        // Kernels older than 5.6, or sandboxes that filter openat2, get the
+        // same guarantee by walking one component at a time.
+        if (fd != -1 || (errno != ENOSYS && errno != EPERM)) {
+            return netcore::fd(fd);
+        }
+
+        auto current = netcore::fd(dup(root));
+
+        for (const auto segment : ext::string_range(path, "/")) {
+            if (!current.valid()) break;
+
+            const auto name = std::string(segment);
+            current = netcore::fd(openat(
+                current,
+                name.c_str(),
+                O_RDONLY | O_CLOEXEC | O_NOFOLLOW
+            ));
+        }
+
+        return current;
+    }
+
+    auto normalize(std::string_view path) -> std::optional<std::string_view> {
+        while (path.starts_with('/')) path.remove_prefix(1);
+        while (path.ends_with('/')) path.remove_suffix(1);
+
+        if (path.find('\0') != std::string_view::npos) return std::nullopt;
+
+        for (const auto segment : ext::string_range(path, "/")) {
+            if (segment == "..") return std::nullopt;
+        }
+
+        return path;
+    }
+
+    auto etag_matches(std::string_view header, std::string_view etag) -> bool {
+        // Compressed responses carry the file's tag with their coding
+        // appended, as in "abc-gzip"; those identify the same file.
+        const auto matches = [etag](std::string_view tag) {
+            if (tag.starts_with("W/")) tag.remove_prefix(2);
+            if (tag == "*" || tag == etag) return true;
+
+            const auto dash = tag.rfind('-');
+            if (dash == std::string_view::npos || !tag.ends_with('"') ||
+                !etag.ends_with('"') ||
+                tag.substr(0, dash) != etag.substr(0, etag.size() - 1)) {
+                return false;
+            }
+
+            const auto name = tag.substr(dash + 1, tag.size() - dash - 2);
+
+            return std::ranges::any_of(codings, [name](auto coding) {
+                return name == http::server::to_string(coding);
+            });
+        };
+
+        for (const auto item : ext::string_range(header, ",")) {
+            if (matches(ext::trim(item))) return true;
+        }
+
+        return false;
+    }
+
+    struct cached_file {
+        std::shared_ptr<const netcore::fd> fd;
+        std::shared_ptr<const http::server::file_encodings> encodings;
+        std::size_t size;
+        std::time_t modified;
+        std::string etag;
+        std::string last_modified;
+        std::string_view content_type;
+        std::string relative;
+    };
+
+    class file_cache {
+        struct entry {
+            std::string key;
+            std::shared_ptr<const cached_file> file;
+        };
+
+        using entry_list = std::list<entry>;
+
+        netcore::fd root;
+        std::string root_path;
+        http::server::static_options options;
+        netcore::fd notify;
+        netcore::fd wakeup;
+        std::mutex mutex;
+        entry_list entries;
+        std::unordered_map<std::string_view, entry_list::iterator> index;
+        std::unordered_map<int, std::string> directories;
+        std::uint64_t generation = 0;
+        std::thread watcher;
+
+        auto erase(entry_list::iterator it) -> void {
+            index.erase(it->key);
+            entries.erase(it);
+        }
+
+        auto invalidate(std::string_view path) -> void {
+            // A change to a precompressed sibling also affects its original.
+            const auto original = [path](std::string_view relative) {
+                if (!path.starts_with(relative)) return false;
+
+                const auto rest = path.substr(relative.size());
+                return std::ranges::any_of(codings, [rest](auto coding) {
+                    return rest == http::server::extension(coding);
+                });
+            };
+
+            // A missing file may appear anywhere beneath its key.
+            const auto missing = [path](std::string_view key) {
+                return key.empty() ||
+                       (path.starts_with(key) && path[key.size()] == '/');
+            };
+
+            auto it = entries.begin();
+
+            while (it != entries.end()) {
+                const auto& relative = it->file ? it->file->relative : it->key;
+                const auto stale = path.empty() || relative == path ||
+                                   (relative.starts_with(path) &&
+                                    relative[path.size()] == '/') ||
+                                   (it->file ? original(relative)
+                                             : missing(relative));
+
+                if (stale) erase(it++);
+                else ++it;
+            }
+        }
+
+        auto load(std::string_view key) -> std::shared_ptr<cached_file> {
+            auto relative = key.empty() ? "."s : std::string(key);
+
+            // Watch the nearest directory that exists, so that creating the
+            // file or any directory leading to it invalidates a cached miss.
+            auto directory = parent(key);
+            while (!watch(directory) && !directory.empty()) {
+                directory = parent(directory);
+            }
+
+            auto fd = open_beneath(root, relative);
+            if (!fd.valid()) return nullptr;
+
+            struct stat info;
+            if (fstat(fd, &info) == -1) return nullptr;
+
+            if (S_ISDIR(info.st_mode)) {
+                watch(key);
+
+                relative = join(key, options.index);
+                fd = open_beneath(root, relative);
+                if (!fd.valid() || fstat(fd, &info) == -1) return nullptr;
+            }
+
+            if (!S_ISREG(info.st_mode)) return nullptr;
+
+            auto file = std::make_shared<cached_file>();
+
+            file->fd = std::make_shared<const netcore::fd>(std::move(fd));
+            file->size = info.st_size;
+            file->modified = info.st_mtim.tv_sec;
+            file->etag = fmt::format(
+                "\"{:x}.{:x}-{:x}\"",
+                info.st_mtim.tv_sec,
+                info.st_mtim.tv_nsec,
+                info.st_size
+            );
+            file->last_modified = format_date(info.st_mtim.tv_sec);
+            file->content_type = http::server::media_type_for(relative);
+            file->encodings = load_encodings(relative, info);
+            file->relative = std::move(relative);
+
+            return file;
+        }
+
+        auto load_encodings(
+            const std::string& relative,
+            const struct stat& info
+        ) -> std::shared_ptr<const http::server::file_encodings> {
+            auto result = std::make_shared<http::server::file_encodings>();
+
+            for (const auto coding : codings) {
+                const auto path = fmt::format(
+                    "{}{}",
+                    relative,
+                    http::server::extension(coding)
+                );
+
+                auto fd = open_beneath(root, path);
+                if (!fd.valid()) continue;
+
+                struct stat sibling;
+                if (fstat(fd, &sibling) == -1 || !S_ISREG(sibling.st_mode)) {
+                    continue;
+                }
+
+                // A sibling older than the original is stale.
+                if (sibling.st_mtim.tv_sec < info.st_mtim.tv_sec) continue;
+
+                auto& encoded = (*result)[std::size_t(coding)];
+                encoded.fd = std::make_shared<const netcore::fd>(std::move(fd));
+                encoded.size = sibling.st_size;
+            }
+
+            return result;
+        }
+
+        auto process(const inotify_event& event) -> void {
+            if (event.mask & IN_Q_OVERFLOW) {
+                index.clear();
+                entries.clear();
+                return;
+            }
+
+            const auto directory = directories.find(event.wd);
+            if (directory == directories.end()) return;
+
+            if (event.mask & IN_IGNORED) {
+                invalidate(directory->second);
+                directories.erase(directory);
+                return;
+            }
+
+            const auto name = std::string_view(event.name);
+            invalidate(join(directory->second, name));
+        }
+
+        auto watch(std::string_view directory) -> bool {
+            const auto path = join(root_path, directory);
+            const auto wd = inotify_add_watch(notify, path.c_str(), watch_mask);
+
+            if (wd == -1) {
+                // Requests for paths that do not exist are expected.
+                if (errno != ENOENT && errno != ENOTDIR) {
+                    TIMBER_WARNING(
+                        "Failed to watch directory '{}': {}",
+                        path,
+                        std::strerror(errno)
+                    );
+                }
+
+                return false;
+            }
+
+            const auto lock = std::scoped_lock(mutex);
+            directories.try_emplace(wd, directory);
+
+            return true;
+        }
+
+        auto watch_events() -> void {
+            auto fds = std::array {
+                pollfd {.fd = notify, .events = POLLIN},
+                pollfd {.fd = wakeup, .events = POLLIN},
+            };
+
+            alignas(inotify_event) auto buffer = std::array<char, 4096>();
+
+            while (true) {
+                if (poll(fds.data(), fds.size(), -1) == -1) {
+                    if (errno == EINTR) continue;
+
+                    TIMBER_ERROR(
+                        "Static file watcher failed: {}",
+                        std::strerror(errno)
+                    );
+                    return;
+                }
+
+                if (fds[1].revents) return;
+
+                while (true) {
+                    const auto size =
+                        read(notify, buffer.data(), buffer.size());
+                    if (size <= 0) break;
+
+                    const auto lock = std::scoped_lock(mutex);
+                    ++generation;
+
+                    auto offset = std::size_t();
+
+                    while (offset < static_cast<std::size_t>(size)) {
+                        const auto& event = *reinterpret_cast<inotify_event*>(
+                            buffer.data() + offset
+                        );
+
+                        process(event);
+                        offset += sizeof(inotify_event) + event.len;
+                    }
+                }
+            }
+        }
+    public:
+        file_cache(
+            const std::filesystem::path& root,
+            const http::server::static_options& options
+        ) :
+            root(open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)),
+            root_path(root.native()),
+            options(options),
+            notify(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+            wakeup(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+            if (!this->root.valid()) {
+                throw system_error(
+                    fmt::format("Failed to open directory '{}'", root_path)
+                );
+            }
+
+            if (!notify.valid()) throw system_error("Failed to create inotify");
+            if (!wakeup.valid()) throw system_error("Failed to create eventfd");
+
+            watcher = std::thread([this] { watch_events(); });
+        }
+
+        file_cache(const file_cache&) = delete;
+
+        file_cache(file_cache&&) = delete;
+
+        ~file_cache() {
+            const std::uint64_t value = 1;
+
+            if (::write(wakeup, &value, sizeof(value)) == -1) {
+                TIMBER_ERROR(
+                    "Failed to stop static file watcher: {}",
+                    std::strerror(errno)
+                );
+            }
+
+            if (watcher.joinable()) watcher.join();
+        }
+
+        auto operator=(const file_cache&) -> file_cache& = delete;
+
+        auto operator=(file_cache&&) -> file_cache& = delete;
+
+        auto find(std::string_view key) -> std::shared_ptr<const cached_file> {
+            auto expected = std::uint64_t();
+
+            {
+                const auto lock = std::scoped_lock(mutex);
+
+                if (const auto it = index.find(key); it != index.end()) {
+                    entries.splice(entries.begin(), entries, it->second);
+                    return it->second->file;
+                }
+
+                expected = generation;
+            }
+
+            // Misses are cached too, so that requests for missing files do
+            // not reach the file system until something changes.
+            auto file = load(key);
+
+            const auto lock = std::scoped_lock(mutex);
+
+            // The file may have changed while it was being loaded; serve it,
+            // but wait for the next request to cache it.
+            if (generation != expected || index.contains(key)) return file;
+
+            auto& entry = entries.emplace_front(std::string(key), file);
+            index.emplace(entry.key, entries.begin());
+
+            if (entries.size() > options.max_entries) {
+                erase(std::prev(entries.end()));
+            }
+
+            return file;
+        }
+    };
+
+    class static_handler final : public http::server::handler {
+        std::shared_ptr<file_cache> cache;
+        std::string param;
+        std::string cache_control;
+
+        auto not_modified(
+            const http::server::request& request,
+            const cached_file& file
+        ) const -> bool {
+            const auto& headers = request.headers;
+
+            if (const auto it = headers.find("if-none-match");
+                it != headers.end()) {
+                return etag_matches(it->second, file.etag);
+            }
+
+            if (const auto it = headers.find("if-modified-since");
+                it != headers.end()) {
+                const auto since = parse_date(it->second);
+                return since && file.modified <= *since;
+            }
+
+            return false;
+        }
+    public:
+        static_handler(
+            std::shared_ptr<file_cache> cache,
+            const http::server::static_options& options
+        ) :
+            cache(std::move(cache)),
+            param(options.param),
+            cache_control(options.cache_control) {}
+
+        auto handle(http::server::stream& stream) -> ext::task<> override {
+            auto& request = stream.request;
+            auto& response = stream.response;
+
+            const auto it = request.params.find(param);
+            const auto key = normalize(
+                it == request.params.end() ? request.path : it->second
+            );
+
+            const auto file = key ? cache->find(*key) : nullptr;
+            if (!file) throw http::error_code(404, "Not Found");
+
+            auto& headers = response.headers;
+
+            headers.emplace("etag", file->etag);
+            headers.emplace("last-modified", file->last_modified);
+
+            if (!cache_control.empty()) {
+                headers.emplace("cache-control", cache_control);
+            }
+
+            if (not_modified(request, *file)) {
+                response.status = 304;
+                co_return;
+            }
+
+            if (request.verb == http::server::method_type::head) {
+                response.content_type(file->content_type);
+                response.content_length(file->size);
+                co_return;
+            }
+
+            response.send(http::server::file {
+                .size = file->size,
+                .content_type = std::string(file->content_type),
+                .shared = file->fd,
+                .encodings = file->encodings});
+        }
+    };
+}
+
+namespace http::server {
+    auto media_type_for(std::string_view path) noexcept -> std::string_view {
+        const auto name = path.substr(path.rfind('/') + 1);
+        const auto dot = name.rfind('.');
+
+        if (dot == std::string_view::npos) return default_media_type;
+
+        const auto extension = name.substr(dot + 1);
+        auto buffer = std::array<char, 16>();
+
+        if (extension.empty() || extension.size() > buffer.size()) {
+            return default_media_type;
+        }
+
+        std::ranges::transform(extension, buffer.begin(), [](char c) {
+            return static_cast<char>(
+                std::tolower(static_cast<unsigned char>(c))
+            );
+        });
+
+        const auto lower = std::string_view(buffer.data(), extension.size());
+        const auto it = std::ranges::lower_bound(
+            media_types,
+            lower,
+            {},
+            &decltype(media_types)::value_type::first
+        );
+
+        if (it == media_types.end() || it->first != lower) {
+            return default_media_type;
+        }
+
+        return it->second;
+    }
+
+    auto static_files(
+        const std::filesystem::path& root,
+        const static_options& options
+    ) -> method_router {
+        const auto cache = std::make_shared<file_cache>(root, options);
+        const auto make = [&]() -> std::unique_ptr<handler> {
+            return std::make_unique<static_handler>(cache, options);
+        };
+
+        auto router = method_router();
+
+        router.use("GET", make());
+        router.use("HEAD", make());
+
+        return router;
+    }
+}
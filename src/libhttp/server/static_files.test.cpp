@@ -0,0 +1,262 @@
+#include <http/server/compression.hpp>
+#include <http/server/static_files.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std::literals;
+
+namespace fs = std::filesystem;
+
+namespace {
+    class StaticFilesTest : public testing::Test {
+    protected:
+        const fs::path base = fs::temp_directory_path() /
+                              ("libhttp.static." + std::to_string(getpid()));
+        const fs::path root = base / "root";
+
+        StaticFilesTest() {
+            fs::remove_all(base);
+            fs::create_directories(root / "docs");
+            fs::create_directories(base / "private");
+
+            write(root / "index.html", "<h1>Home</h1>");
+            write(root / "docs" / "guide.txt", "guide");
+            write(root / "docs" / "notes.txt", "notes");
+            write(base / "private" / "secret.txt", "secret");
+        }
+
+        ~StaticFilesTest() { fs::remove_all(base); }
+
+        auto get(
+            http::server::method_router& router,
+            std::string_view path,
+            std::string_view etag = "",
+            std::string_view accept_encoding = ""
+        ) -> std::unique_ptr<http::server::stream> {
+            auto stream = std::make_unique<http::server::stream>();
+            auto& request = stream->request;
+
+            request.method = "GET";
+            request.verb = http::server::method_type::get;
+            request.params.emplace("path", path);
+
+            if (!etag.empty()) request.headers.emplace("if-none-match", etag);
+
+            if (!accept_encoding.empty()) {
+                request.headers.emplace("accept-encoding", accept_encoding);
+            }
+
+            auto* const handler =
+                router.find(http::server::method_type::get, "GET");
+
+            netcore::run([&]() -> ext::task<> {
+                try {
+                    co_await handler->handle(*stream);
+                }
+                catch (const http::error_code& error) {
+                    stream->response.status = error.code();
+                }
+            }());
+
+            return stream;
+        }
+
+        static auto etag(const http::server::stream& stream) -> std::string {
+            const auto* const field = stream.response.headers.find("etag");
+            return field ? std::string(field->value) : ""s;
+        }
+
+        static auto file(const http::server::stream& stream)
+            -> const http::server::file& {
+            return std::get<http::server::file>(stream.response.data);
+        }
+
+        static auto write(const fs::path& path, std::string_view content)
+            -> void {
+            auto file = std::ofstream(path);
+            file << content;
+        }
+    };
+}
+
+TEST(StaticFiles, MediaType) {
+    using http::server::media_type_for;
+
+    EXPECT_EQ("text/html; charset=utf-8"sv, media_type_for("index.html"));
+    EXPECT_EQ("text/css; charset=utf-8"sv, media_type_for("css/site.CSS"));
+    EXPECT_EQ("image/png"sv, media_type_for("/a.b/logo.png"));
+    EXPECT_EQ("font/woff2"sv, media_type_for("fonts/inter.woff2"));
+    EXPECT_EQ("application/octet-stream"sv, media_type_for("README"));
+    EXPECT_EQ("application/octet-stream"sv, media_type_for("a.b/c"));
+    EXPECT_EQ("application/octet-stream"sv, media_type_for("archive.7z"));
+    EXPECT_EQ("application/octet-stream"sv, media_type_for("trailing."));
+    EXPECT_EQ("application/octet-stream"sv, media_type_for("a.\xc3\x89PG"));
+}
+
+TEST_F(StaticFilesTest, Serve) {
+    auto router = http::server::static_files(root);
+
+    const auto index = get(router, "/");
+    EXPECT_EQ(13, file(*index).size);
+    EXPECT_EQ("text/html; charset=utf-8", file(*index).content_type);
+
+    const auto guide = get(router, "docs/guide.txt");
+    EXPECT_EQ(5, file(*guide).size);
+    EXPECT_EQ(404, get(router, "docs/missing.txt")->response.status);
+}
+
+TEST_F(StaticFilesTest, CacheHit) {
+    auto router = http::server::static_files(root);
+
+    const auto first = get(router, "docs/guide.txt");
+    const auto second = get(router, "docs/guide.txt");
+
+    EXPECT_EQ(file(*first).shared, file(*second).shared);
+}
+
+TEST_F(StaticFilesTest, NotModified) {
+    auto router = http::server::static_files(root);
+
+    const auto first = get(router, "docs/guide.txt");
+    const auto tag = etag(*first);
+    ASSERT_FALSE(tag.empty());
+
+    const auto second = get(router, "docs/guide.txt", tag);
+    EXPECT_EQ(304, second->response.status);
+    EXPECT_TRUE(
+        std::holds_alternative<std::monostate>(second->response.data)
+    );
+
+    const auto third = get(router, "docs/guide.txt", "\"other\"");
+    EXPECT_NE(304, third->response.status);
+}
+
+TEST_F(StaticFilesTest, Invalidate) {
+    auto router = http::server::static_files(root);
+
+    const auto first = get(router, "docs/guide.txt");
+    write(root / "docs" / "guide.txt", "a longer guide");
+
+    // The watcher thread picks up the change asynchronously.
+    auto size = file(*first).size;
+
+    for (auto i = 0; i < 100 && size != 14; ++i) {
+        std::this_thread::sleep_for(10ms);
+        size = file(*get(router, "docs/guide.txt")).size;
+    }
+
+    EXPECT_EQ(14, size);
+}
+
+TEST_F(StaticFilesTest, Missing) {
+    auto router = http::server::static_files(root);
+
+    EXPECT_EQ(404, get(router, "docs/new.txt")->response.status);
+    EXPECT_EQ(404, get(router, "new/guide.txt")->response.status);
+
+    write(root / "docs" / "new.txt", "new");
+    fs::create_directory(root / "new");
+    write(root / "new" / "guide.txt", "guide");
+
+    // Cached misses are dropped once the watcher sees the new files.
+    auto status = 404;
+
+    for (auto i = 0; i < 100 && status == 404; ++i) {
+        std::this_thread::sleep_for(10ms);
+        status = get(router, "docs/new.txt")->response.status;
+    }
+
+    EXPECT_NE(404, status);
+    status = 404;
+
+    for (auto i = 0; i < 100 && status == 404; ++i) {
+        std::this_thread::sleep_for(10ms);
+        status = get(router, "new/guide.txt")->response.status;
+    }
+
+    EXPECT_NE(404, status);
+}
+
+TEST_F(StaticFilesTest, Evict) {
+    auto router = http::server::static_files(root, {.max_entries = 1});
+
+    const auto first = get(router, "docs/guide.txt");
+    const auto other = get(router, "docs/notes.txt");
+    const auto second = get(router, "docs/guide.txt");
+
+    EXPECT_NE(file(*first).shared, file(*second).shared);
+}
+
+TEST_F(StaticFilesTest, Traversal) {
+    auto router = http::server::static_files(root);
+
+    EXPECT_EQ(404, get(router, "../private/secret.txt")->response.status);
+    EXPECT_EQ(
+        404,
+        get(router, "docs/../../private/secret.txt")->response.status
+    );
+}
+
+TEST_F(StaticFilesTest, Symlink) {
+    fs::create_symlink(base / "private" / "secret.txt", root / "secret.txt");
+    fs::create_directory_symlink(base / "private", root / "private");
+
+    auto router = http::server::static_files(root);
+
+    EXPECT_EQ(404, get(router, "secret.txt")->response.status);
+    EXPECT_EQ(404, get(router, "private/secret.txt")->response.status);
+}
+
+TEST_F(StaticFilesTest, Precompressed) {
+    using http::server::content_coding;
+
+    write(root / "docs" / "guide.txt.gz", "gz");
+    fs::create_symlink(
+        base / "private" / "secret.txt",
+        root / "docs" / "guide.txt.br"
+    );
+
+    auto router = http::server::static_files(root);
+
+    const auto stream = get(router, "docs/guide.txt");
+    const auto& encodings = file(*stream).encodings;
+    ASSERT_TRUE(encodings);
+
+    const auto& gzip = (*encodings)[std::size_t(content_coding::gzip)];
+    EXPECT_TRUE(gzip.fd);
+    EXPECT_EQ(2, gzip.size);
+
+    EXPECT_FALSE((*encodings)[std::size_t(content_coding::br)].fd);
+    EXPECT_FALSE((*encodings)[std::size_t(content_coding::zstd)].fd);
+}
+
+TEST_F(StaticFilesTest, PrecompressedNotModified) {
+    const auto options = http::server::compression_options();
+
+    write(root / "docs" / "guide.txt.gz", "gz");
+
+    auto router = http::server::static_files(root);
+
+    const auto first = get(router, "docs/guide.txt", "", "gzip");
+    http::server::compress(first->request, first->response, options);
+
+    const auto tag = etag(*first);
+    EXPECT_TRUE(tag.ends_with("-gzip\""));
+
+    const auto second = get(router, "docs/guide.txt", tag, "gzip");
+    EXPECT_EQ(304, second->response.status);
+
+    http::server::compress(second->request, second->response, options);
+
+    const auto* const vary = second->response.headers.find("vary");
+    ASSERT_TRUE(vary);
+    EXPECT_EQ("accept-encoding", vary->value);
+    EXPECT_EQ(tag, etag(*second));
+
+    const auto other = get(router, "docs/guide.txt", "\"x-gzip\"", "gzip");
+    EXPECT_NE(304, other->response.status);
+}
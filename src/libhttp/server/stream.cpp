@@ -13,6 +13,11 @@ namespace {
         constexpr auto authority = ":authority"sv;
     }
 
+    auto view(nghttp2_rcbuf* buffer) noexcept -> std::string_view {
+        const auto data = nghttp2_rcbuf_get_buf(buffer);
+        return {reinterpret_cast<const char*>(data.base), data.len};
+    }
+
     auto hex_to_uint(char c) -> std::uint8_t {
         if (c >= '0' && c <= '9') return c - '0';
         if (c >= 'A' && c <= 'F') return c - 'A' + 10;
@@ -59,18 +64,59 @@ namespace {
 namespace http::server {
     stream::stream() : id(-1) {}
 
-    stream::stream(std::int32_t id) : id(id) {
+    stream::stream(std::int32_t id, std::pmr::memory_resource* upstream) :
+        arena(initial_buffer.data(), initial_buffer.size(), upstream),
+        id(id),
+        request(&arena) {
         TIMBER_TRACE("Stream ID {} opened", id);
     }
 
     stream::~stream() {
         unlink();
+        abort();
+        release();
 
+        if (id != -1) { TIMBER_TRACE("Stream ID {} closed", id); }
+    }
+
+    auto stream::abort() noexcept -> void {
         if (request.continuation)
             request.continuation.resume(std::make_exception_ptr(stream_aborted()
             ));
 
+        if (auto* const body = std::get_if<streaming_body>(&response.data)) {
+            body->writer->abort();
+        }
+    }
+
+    auto stream::clear() noexcept -> void {
+        abort();
+
+        read_timeout.cancel();
+        handler_timeout.cancel();
+
         if (id != -1) { TIMBER_TRACE("Stream ID {} closed", id); }
+
+        response.clear();
+
+        std::destroy_at(&request);
+        release();
+        arena.release();
+        std::construct_at(&request, &arena);
+
+        inbox.clear();
+        held.clear();
+        unconsumed = 0;
+        received = 0;
+        header_count = 0;
+        header_size = 0;
+
+        id = -1;
+        active = false;
+        open = true;
+        ended = false;
+        pumping = false;
+        rejected = false;
     }
 
     auto stream::delete_all() noexcept -> void {
@@ -86,6 +132,8 @@ namespace http::server {
     auto stream::empty() const noexcept -> bool { return next == this; }
 
     auto stream::link(stream& other) noexcept -> void {
+        other.unlink();
+
         other.next = this;
         other.prev = prev;
 
@@ -93,24 +141,13 @@ namespace http::server {
         prev = &other;
     }
 
-    auto stream::process_path(std::string_view path) -> void {
-        auto storage = std::unique_ptr<char[]>(new char[path.size() + 2]);
+    auto stream::pop() noexcept -> stream* {
+        if (empty()) return nullptr;
 
-        auto* const buffer = storage.get();
-        std::size_t pos = 0;
+        auto* const result = next;
+        result->unlink();
 
-        auto query = std::string_view();
-        const auto query_start = path.find('?');
-        if (query_start != std::string_view::npos) {
-            query = path.substr(query_start + 1);
-            path = path.substr(0, query_start);
-        }
-
-        request.path = percent_decode(path, buffer, pos);
-
-        if (!query.empty()) process_query(query, buffer, pos);
-
-        path_storage = std::move(storage);
+        return result;
     }
 
     auto stream::process_query(
@@ -141,17 +178,69 @@ namespace http::server {
         }
     }
 
-    auto stream::recv_header(std::string_view name, std::string_view value)
+    auto stream::recv_header(nghttp2_rcbuf* name, nghttp2_rcbuf* value)
         -> void {
-        TIMBER_TRACE("Stream ID {} received header '{}: {}'", id, name, value);
+        const auto n = view(name);
+        const auto v = view(value);
+
+        TIMBER_TRACE("Stream ID {} received header '{}: {}'", id, n, v);
+
+        if (n == header::path) {
+            recv_path(v);
+            return;
+        }
 
-        if (name == header::method) request.method = value;
-        else if (name == header::path) process_path(value);
+        // Keep nghttp2's buffers alive instead of copying their contents.
+        for (auto* const buffer : {name, value}) {
+            nghttp2_rcbuf_incref(buffer);
+            buffers.push_back(buffer);
+        }
+
+        set_header(n, v);
+    }
+
+    auto stream::recv_path(std::string_view path) -> void {
+        auto* const buffer =
+            static_cast<char*>(arena.allocate(path.size() + 2, alignof(char)));
+        std::size_t pos = 0;
+
+        auto query = std::string_view();
+        const auto query_start = path.find('?');
+        if (query_start != std::string_view::npos) {
+            query = path.substr(query_start + 1);
+            path = path.substr(0, query_start);
+        }
+
+        request.path = percent_decode(path, buffer, pos);
+
+        if (!query.empty()) process_query(query, buffer, pos);
+    }
+
+    auto stream::release() noexcept -> void {
+        for (auto* const buffer : buffers) nghttp2_rcbuf_decref(buffer);
+        buffers.clear();
+    }
+
+    auto stream::set_header(std::string_view name, std::string_view value)
+        -> void {
+        if (name == header::method) {
+            request.method = value;
+            request.verb = parse_method(value);
+        }
         else if (name == header::scheme) request.scheme = value;
         else if (name == header::authority) request.authority = value;
         else request.headers.emplace(name, value);
     }
 
+    auto stream::store(std::string_view string) -> std::string_view {
+        auto* const data =
+            static_cast<char*>(arena.allocate(string.size(), alignof(char)));
+
+        string.copy(data, string.size());
+
+        return {data, string.size()};
+    }
+
     auto stream::unlink() noexcept -> void {
         next->prev = prev;
         prev->next = next;
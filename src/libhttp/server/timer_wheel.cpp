@@ -0,0 +1,167 @@
+#include <http/server/timer_wheel.hpp>
+
+#include <netcore/netcore>
+
+namespace http::server {
+    timeout::timeout(std::function<void()>&& callback) :
+        callback(std::forward<std::function<void()>>(callback)) {}
+
+    timeout::~timeout() { cancel(); }
+
+    auto timeout::arm(std::chrono::milliseconds duration) -> void {
+        arm(timer_wheel::local(), duration);
+    }
+
+    auto timeout::arm(timer_wheel& wheel, std::chrono::milliseconds duration)
+        -> void {
+        wheel.add(*this, duration);
+    }
+
+    auto timeout::armed() const noexcept -> bool { return wheel != nullptr; }
+
+    auto timeout::cancel() noexcept -> void {
+        if (wheel) wheel->remove(*this);
+        else unlink();
+    }
+
+    auto timeout::link(timeout& other) noexcept -> void {
+        other.unlink();
+
+        other.next = this;
+        other.prev = prev;
+
+        prev->next = &other;
+        prev = &other;
+    }
+
+    auto timeout::set_callback(std::function<void()>&& callback) -> void {
+        this->callback = std::forward<std::function<void()>>(callback);
+    }
+
+    auto timeout::unlink() noexcept -> void {
+        next->prev = prev;
+        prev->next = next;
+
+        next = this;
+        prev = this;
+    }
+
+    auto timer_wheel::local() -> timer_wheel& {
+        thread_local auto instance = timer_wheel(true);
+        return instance;
+    }
+
+    timer_wheel::timer_wheel(bool driven) : driven(driven) {}
+
+    auto timer_wheel::add(timeout& timeout, std::chrono::milliseconds duration)
+        -> void {
+        timeout.cancel();
+
+        if (duration <= std::chrono::milliseconds::zero()) return;
+
+        const auto ticks =
+            (duration.count() + resolution.count() - 1) / resolution.count();
+
+        timeout.expiry = now + static_cast<std::uint64_t>(ticks);
+        timeout.wheel = this;
+        ++count;
+
+        schedule(timeout);
+
+        if (driven && !running) run();
+    }
+
+    auto timer_wheel::cascade(unsigned int level) -> void {
+        auto& slot = wheel[level][(now >> (bits * level)) & (slots - 1)];
+        auto pending = timeout();
+
+        while (slot.next != &slot) pending.link(*slot.next);
+
+        while (pending.next != &pending) {
+            auto& entry = *pending.next;
+            entry.unlink();
+            schedule(entry);
+        }
+    }
+
+    auto timer_wheel::remove(timeout& timeout) noexcept -> void {
+        if (timeout.wheel != this) return;
+
+        timeout.unlink();
+        timeout.wheel = nullptr;
+        --count;
+    }
+
+    auto timer_wheel::run() -> ext::detached_task {
+        running = true;
+
+        auto timer = netcore::timer::monotonic();
+        timer.set(resolution, resolution);
+
+        // The driver only runs while timeouts are armed so that an idle
+        // runtime is free to exit.
+        while (count > 0) {
+            const auto expirations = co_await timer.wait();
+
+            for (auto i = std::uint64_t(); i < expirations; ++i) tick();
+        }
+
+        running = false;
+    }
+
+    auto timer_wheel::schedule(timeout& timeout) noexcept -> void {
+        const auto delta = timeout.expiry > now ? timeout.expiry - now : 0;
+
+        auto level = 0u;
+        while (level < levels - 1 && (delta >> (bits * (level + 1))) != 0) {
+            ++level;
+        }
+
+        const auto slot = (timeout.expiry >> (bits * level)) & (slots - 1);
+        wheel[level][slot].link(timeout);
+    }
+
+    auto timer_wheel::size() const noexcept -> std::size_t { return count; }
+
+    auto timer_wheel::tick() -> void {
+        ++now;
+
+        // Move timeouts that fall within the next revolution of a lower
+        // level down before expiring the current slot.
+        for (auto level = levels - 1; level > 0; --level) {
+            const auto span = std::uint64_t(1) << (bits * level);
+            if ((now & (span - 1)) == 0) cascade(level);
+        }
+
+        auto& slot = wheel[0][now & (slots - 1)];
+        auto expired = timeout();
+
+        while (slot.next != &slot) expired.link(*slot.next);
+
+        while (expired.next != &expired) {
+            auto& entry = *expired.next;
+
+            // Deadlines beyond the top level wrap around and come back.
+            if (entry.expiry > now) {
+                entry.unlink();
+                schedule(entry);
+                continue;
+            }
+
+            remove(entry);
+            if (!entry.callback) continue;
+
+            // The remaining entries are only linked to `expired`, so a
+            // failing callback must not end the tick.
+            try {
+                entry.callback();
+            }
+            catch (const std::exception& ex) {
+                TIMBER_ERROR("Timeout callback failed: {}", ex.what());
+            }
+            catch (...) {
+                TIMBER_ERROR("Timeout callback failed");
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <http/server/timer_wheel.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace std::literals;
+
+using http::server::timer_wheel;
+
+namespace {
+    auto elapse(timer_wheel& wheel, std::chrono::milliseconds duration)
+        -> void {
+        for (auto i = 0; i < duration / timer_wheel::resolution; ++i) {
+            wheel.tick();
+        }
+    }
+}
+
+TEST(TimerWheel, Expire) {
+    auto wheel = timer_wheel();
+    auto fired = 0;
+    auto timeout = http::server::timeout([&] { ++fired; });
+
+    timeout.arm(wheel, 1s);
+    EXPECT_TRUE(timeout.armed());
+    EXPECT_EQ(1, wheel.size());
+
+    elapse(wheel, 900ms);
+    EXPECT_EQ(0, fired);
+
+    elapse(wheel, 100ms);
+    EXPECT_EQ(1, fired);
+    EXPECT_FALSE(timeout.armed());
+    EXPECT_EQ(0, wheel.size());
+}
+
+TEST(TimerWheel, Cascade) {
+    auto wheel = timer_wheel();
+    auto order = std::vector<int>();
+
+    auto first = http::server::timeout([&] { order.push_back(1); });
+    auto second = http::server::timeout([&] { order.push_back(2); });
+    auto third = http::server::timeout([&] { order.push_back(3); });
+
+    elapse(wheel, 3s);
+
+    third.arm(wheel, 2h);
+    second.arm(wheel, 10min);
+    first.arm(wheel, 7s);
+
+    elapse(wheel, 7s);
+    EXPECT_EQ(std::vector<int>({1}), order);
+
+    elapse(wheel, 10min - 7s - 100ms);
+    EXPECT_EQ(std::vector<int>({1}), order);
+
+    elapse(wheel, 100ms);
+    EXPECT_EQ(std::vector<int>({1, 2}), order);
+
+    elapse(wheel, 2h - 10min);
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), order);
+    EXPECT_EQ(0, wheel.size());
+}
+
+TEST(TimerWheel, Cancel) {
+    auto wheel = timer_wheel();
+    auto fired = 0;
+    auto timeout = http::server::timeout([&] { ++fired; });
+
+    timeout.arm(wheel, 500ms);
+    timeout.cancel();
+
+    EXPECT_FALSE(timeout.armed());
+    EXPECT_EQ(0, wheel.size());
+
+    elapse(wheel, 1s);
+    EXPECT_EQ(0, fired);
+}
+
+TEST(TimerWheel, Rearm) {
+    auto wheel = timer_wheel();
+    auto fired = 0;
+    auto timeout = http::server::timeout([&] { ++fired; });
+
+    timeout.arm(wheel, 500ms);
+    elapse(wheel, 400ms);
+
+    timeout.arm(wheel, 500ms);
+    elapse(wheel, 400ms);
+    EXPECT_EQ(0, fired);
+
+    elapse(wheel, 100ms);
+    EXPECT_EQ(1, fired);
+
+    timeout.arm(wheel, 0ms);
+    EXPECT_FALSE(timeout.armed());
+}
+
+TEST(TimerWheel, CallbackThrows) {
+    auto wheel = timer_wheel();
+    auto fired = 0;
+
+    auto first = http::server::timeout([] {
+        throw std::runtime_error("callback failed");
+    });
+    auto second = http::server::timeout([&] { ++fired; });
+
+    first.arm(wheel, 100ms);
+    second.arm(wheel, 100ms);
+
+    EXPECT_NO_THROW(elapse(wheel, 100ms));
+    EXPECT_EQ(1, fired);
+    EXPECT_FALSE(second.armed());
+    EXPECT_EQ(0, wheel.size());
+}